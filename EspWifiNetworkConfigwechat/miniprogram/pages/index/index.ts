@@ -1,4 +1,11 @@
 // index.ts
+import { decodeCbor, decodeUtf8 } from '../../utils/cbor'
+import { discoverDevices, deviceBaseUrl, DeviceInfo } from '../../utils/discovery'
+
+// 未发现设备时使用SoftAP的默认地址
+const DEFAULT_BASE_URL = 'http://192.168.4.1:8080'
+const REDISCOVER_INTERVAL = 5000
+
 Page({
   data: {
     ssid: '',
@@ -8,10 +15,16 @@ Page({
       ssid: '',
       connected: false
     },
-    checkTimer: null as any
+    checkTimer: null as any,
+    statusPending: false,
+    baseUrl: DEFAULT_BASE_URL,
+    deviceId: '',
+    discovering: false,
+    lastDiscover: 0
   },
 
   onLoad() {
+    this.findDevice()
     this.startAutoCheck()
   },
 
@@ -49,18 +62,69 @@ Page({
     }
   },
 
+  // 查找局域网中的设备，多台设备时由用户选择
+  findDevice() {
+    if (this.data.discovering) {
+      return
+    }
+    this.setData({ discovering: true, lastDiscover: Date.now() })
+    discoverDevices().then((devices) => {
+      this.setData({ discovering: false })
+      if (devices.length === 0) {
+        return
+      }
+      // 已选中的设备换了地址时直接跟随
+      const current = devices.filter((d) => d.id === this.data.deviceId)
+      if (current.length > 0 || devices.length === 1) {
+        this.useDevice(current.length > 0 ? current[0] : devices[0])
+        return
+      }
+      const choices = devices.slice(0, 6)
+      wx.showActionSheet({
+        itemList: choices.map((d) => `${d.id} (${d.state})`),
+        success: (res) => this.useDevice(choices[res.tapIndex])
+      })
+    })
+  },
+
+  useDevice(device: DeviceInfo) {
+    this.setData({
+      baseUrl: deviceBaseUrl(device),
+      deviceId: device.id
+    })
+  },
+
   // 刷新ESP32状态
   refreshStatus() {
+    // 上一次请求未返回时跳过，保证轮询始终复用同一个连接
+    if (this.data.statusPending) {
+      return
+    }
+    this.data.statusPending = true
     wx.request({
-      url: 'http://192.168.4.1:8080/get_status',
+      url: `${this.data.baseUrl}/get_status`,
       method: 'GET',
       timeout: 3000,
+      // 轮询频繁，使用CBOR减少传输与解析开销
+      header: {
+        'Accept': 'application/cbor'
+      },
+      responseType: 'arraybuffer',
       success: (res) => {
+        const contentType = res.header['Content-Type'] || res.header['content-type'] || ''
+        let data: any
+        try {
+          data = contentType.indexOf('cbor') >= 0
+            ? decodeCbor(res.data as ArrayBuffer)
+            : JSON.parse(decodeUtf8(res.data as ArrayBuffer))
+        } catch (e) {
+          data = {}
+        }
         this.setData({
           espStatus: true,
           wifiInfo: {
-            ssid: res.data.ssid || '',
-            connected: res.data.connected || false
+            ssid: data.ssid || '',
+            connected: data.connected || false
           }
         })
       },
@@ -72,6 +136,13 @@ Page({
             connected: false
           }
         })
+        // 设备可能已切换到其他网络，定期重新查找
+        if (Date.now() - this.data.lastDiscover > REDISCOVER_INTERVAL) {
+          this.findDevice()
+        }
+      },
+      complete: () => {
+        this.data.statusPending = false
       }
     })
   },
@@ -86,32 +157,16 @@ Page({
       return
     }
 
-    // 检查是否已连接到ESP32 AP
-    wx.request({
-      url: 'http://192.168.4.1:8080',
-      method: 'GET',
-      timeout: 3000,
-      success: () => {
-        // 可以访问ESP32，发送配网信息
-        this.doSendConfig()
-      },
-      fail: () => {
-        wx.showModal({
-          title: '连接错误',
-          content: '请确保已连接到ESP32的WiFi热点',
-          showCancel: false
-        })
-      }
-    })
+    // 探测与配网合并为一次请求，/config 的响应同时携带设备信息
+    this.doSendConfig()
   },
 
   // 执行配网请求
   doSendConfig() {
     wx.request({
-      url: 'http://192.168.4.1:8080/config',
+      url: `${this.data.baseUrl}/config`,
       method: 'POST',
       timeout: 10000,
-      enableHttp2: true,
       header: {
         'content-type': 'application/json'
       },
@@ -119,17 +174,28 @@ Page({
         ssid: this.data.ssid,
         password: this.data.password
       },
-      success: () => {
+      success: (res) => {
+        const data = res.data as any
+        if (res.statusCode !== 200 || data.status !== 'success') {
+          wx.showModal({
+            title: '配网失败',
+            content: '请检查WiFi信息是否正确',
+            showCancel: false
+          })
+          return
+        }
+        this.setData({ espStatus: true })
         wx.showToast({
           title: '发送成功',
           icon: 'success'
         })
       },
       fail: (error) => {
+        // 请求未到达设备，说明未连接到ESP32热点
         console.error('配网失败:', error)
         wx.showModal({
-          title: '配网失败',
-          content: '请检查WiFi信息是否正确，并确保ESP32在线',
+          title: '连接错误',
+          content: '请确保已连接到ESP32的WiFi热点',
           showCancel: false
         })
       }
@@ -144,7 +210,7 @@ Page({
       success: (res) => {
         if (res.confirm) {
           wx.request({
-            url: 'http://192.168.4.1:8080/delete_wifi',
+            url: `${this.data.baseUrl}/delete_wifi`,
             method: 'POST',
             success: () => {
               wx.showToast({
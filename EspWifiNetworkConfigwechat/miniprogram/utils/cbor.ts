@@ -0,0 +1,84 @@
+// 精简CBOR解码器，仅支持设备接口用到的类型：整数、文本串、数组、映射、布尔、null
+
+const utf8Decode = (bytes: Uint8Array, start: number, end: number) => {
+  let out = ''
+  let i = start
+  while (i < end) {
+    const b = bytes[i++]
+    let cp = b
+    if (b >= 0xf0) {
+      cp = ((b & 0x07) << 18) | ((bytes[i++] & 0x3f) << 12) | ((bytes[i++] & 0x3f) << 6) | (bytes[i++] & 0x3f)
+    } else if (b >= 0xe0) {
+      cp = ((b & 0x0f) << 12) | ((bytes[i++] & 0x3f) << 6) | (bytes[i++] & 0x3f)
+    } else if (b >= 0xc0) {
+      cp = ((b & 0x1f) << 6) | (bytes[i++] & 0x3f)
+    }
+    if (cp > 0xffff) {
+      cp -= 0x10000
+      out += String.fromCharCode(0xd800 + (cp >> 10), 0xdc00 + (cp & 0x3ff))
+    } else {
+      out += String.fromCharCode(cp)
+    }
+  }
+  return out
+}
+
+export const decodeUtf8 = (buffer: ArrayBuffer) => {
+  const bytes = new Uint8Array(buffer)
+  return utf8Decode(bytes, 0, bytes.length)
+}
+
+export const decodeCbor = (buffer: ArrayBuffer): any => {
+  const bytes = new Uint8Array(buffer)
+  let pos = 0
+
+  const readArg = (info: number) => {
+    if (info < 24) return info
+    const size = info === 24 ? 1 : info === 25 ? 2 : info === 26 ? 4 : 8
+    let value = 0
+    for (let i = 0; i < size; i++) {
+      value = value * 256 + bytes[pos++]
+    }
+    return value
+  }
+
+  const readItem = (): any => {
+    const head = bytes[pos++]
+    const major = head >> 5
+    const info = head & 0x1f
+    if (major === 7) {
+      if (info === 20) return false
+      if (info === 21) return true
+      return null
+    }
+    const arg = readArg(info)
+    switch (major) {
+      case 0:
+        return arg
+      case 1:
+        return -1 - arg
+      case 3: {
+        const text = utf8Decode(bytes, pos, pos + arg)
+        pos += arg
+        return text
+      }
+      case 4: {
+        const list = []
+        for (let i = 0; i < arg; i++) list.push(readItem())
+        return list
+      }
+      case 5: {
+        const map: Record<string, any> = {}
+        for (let i = 0; i < arg; i++) {
+          const key = readItem()
+          map[key] = readItem()
+        }
+        return map
+      }
+      default:
+        throw new Error('unsupported cbor type ' + major)
+    }
+  }
+
+  return readItem()
+}
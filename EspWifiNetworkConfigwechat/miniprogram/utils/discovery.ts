@@ -0,0 +1,41 @@
+// 局域网设备发现：广播一次请求，在超时时间内收集所有设备的回复
+import { decodeUtf8 } from './cbor'
+
+export interface DeviceInfo {
+  id: string
+  ip: string
+  ap_ip: string
+  port: number
+  fw: string
+  state: string
+  address: string   // 回复的来源地址，即手机可以访问到的设备地址
+}
+
+const DISCOVERY_PORT = 48899
+const DISCOVERY_QUERY = 'ESPWIFI_DISCOVER'
+
+export const discoverDevices = (timeout = 1000): Promise<DeviceInfo[]> => new Promise((resolve) => {
+  const devices: { [id: string]: DeviceInfo } = {}
+  const udp = wx.createUDPSocket()
+  udp.bind()
+  udp.onMessage((res) => {
+    try {
+      const info = JSON.parse(decodeUtf8(res.message)) as DeviceInfo
+      info.address = res.remoteInfo.address
+      devices[info.id] = info
+    } catch (e) {
+      // 忽略无法解析的报文
+    }
+  })
+  udp.send({
+    address: '255.255.255.255',
+    port: DISCOVERY_PORT,
+    message: DISCOVERY_QUERY
+  })
+  setTimeout(() => {
+    udp.close()
+    resolve(Object.keys(devices).map((id) => devices[id]))
+  }, timeout)
+})
+
+export const deviceBaseUrl = (device: DeviceInfo) => `http://${device.address}:${device.port}`
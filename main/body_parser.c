@@ -0,0 +1,533 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 10:00:00
+ * @Description: 流式请求体解析器实现
+ */
+
+#include <string.h>
+#include "body_parser.h"
+
+// 解析状态
+enum {
+    // JSON
+    J_VALUE,            // 期待一个值
+    J_OBJ_FIRST,        // '{' 之后，期待键或 '}'
+    J_OBJ_KEY,          // ',' 之后，期待键
+    J_COLON,            // 键之后，期待 ':'
+    J_ARR_FIRST,        // '[' 之后，期待值或 ']'
+    J_AFTER_VALUE,      // 值之后，期待 ',' 或闭合括号
+    J_STRING,
+    J_STRING_ESC,
+    J_STRING_HEX,
+    J_NUMBER,           // 数字，可被提取为文本
+    J_WORD,             // true、false、null，逐字符比较，不提取
+    J_DONE,
+    // 表单
+    F_KEY,
+    F_VALUE,
+    F_HEX,
+};
+
+// 数字语法 -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)? 中的位置
+enum {
+    N_SIGN,             // '-' 之后
+    N_ZERO,             // 整数部分为0
+    N_INT,
+    N_DOT,              // '.' 之后
+    N_FRAC,
+    N_EXP,              // 'e' 之后
+    N_EXP_SIGN,
+    N_EXP_INT,
+};
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool is_number_char(char c)
+{
+    return (c >= '0' && c <= '9') || c == '.' || c == '+' || c == '-' || c == 'e' || c == 'E';
+}
+
+// 数字中的下一个字符，不符合语法时返回false
+static bool number_next(uint8_t *state, char c)
+{
+    bool digit = c >= '0' && c <= '9';
+    bool exp = c == 'e' || c == 'E';
+    switch (*state) {
+    case N_SIGN:
+        if (!digit) return false;
+        *state = c == '0' ? N_ZERO : N_INT;
+        return true;
+    case N_ZERO:
+    case N_INT:
+        if (digit && *state == N_INT) return true;
+        if (c == '.') { *state = N_DOT; return true; }
+        if (exp) { *state = N_EXP; return true; }
+        return false;
+    case N_DOT:
+    case N_FRAC:
+        if (digit) { *state = N_FRAC; return true; }
+        if (exp && *state == N_FRAC) { *state = N_EXP; return true; }
+        return false;
+    case N_EXP:
+        if (c == '+' || c == '-') { *state = N_EXP_SIGN; return true; }
+        /* fall through */
+    case N_EXP_SIGN:
+    case N_EXP_INT:
+        if (digit) { *state = N_EXP_INT; return true; }
+        return false;
+    default:
+        return false;
+    }
+}
+
+// 数字能否在此结束
+static bool number_complete(uint8_t state)
+{
+    return state == N_ZERO || state == N_INT || state == N_FRAC || state == N_EXP_INT;
+}
+
+static void reset_fields(body_parser_t *p)
+{
+    for (size_t i = 0; i < p->field_count; i++) {
+        p->fields[i].present = false;
+        if (p->fields[i].size > 0) {
+            p->fields[i].buf[0] = '\0';
+        }
+    }
+    p->record_dirty = false;
+}
+
+static esp_err_t emit_record(body_parser_t *p)
+{
+    if (!p->record_dirty) {
+        return ESP_OK;
+    }
+    p->records++;
+    if (p->on_record == NULL) {
+        p->record_dirty = false;  // 没有回调时字段留给调用者在解析结束后读取
+        return ESP_OK;
+    }
+    esp_err_t err = p->on_record(p->fields, p->field_count, p->ctx);
+    reset_fields(p);
+    return err;
+}
+
+// 键或值开始
+static void begin_token(body_parser_t *p, bool is_key)
+{
+    p->in_key = is_key;
+    p->value_len = 0;
+    p->high_surrogate = 0;
+    if (is_key) {
+        p->key_len = 0;
+        p->key_overflow = false;
+        p->field = -1;
+    }
+}
+
+// 追加一个已解码的字节
+static esp_err_t append_byte(body_parser_t *p, char c)
+{
+    if (p->in_key) {
+        if (p->key_len < BODY_PARSER_KEY_MAX) {
+            p->key[p->key_len++] = c;
+        } else {
+            p->key_overflow = true;
+        }
+        return ESP_OK;
+    }
+    if (p->field < 0) {
+        return ESP_OK;  // 不关心的值直接丢弃
+    }
+    body_field_t *f = &p->fields[p->field];
+    if (p->value_len + 1 >= f->size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    f->buf[p->value_len++] = c;
+    return ESP_OK;
+}
+
+static esp_err_t append_utf8(body_parser_t *p, uint32_t cp)
+{
+    char out[4];
+    size_t n;
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        n = 1;
+    } else if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        n = 2;
+    } else if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        n = 3;
+    } else {
+        out[0] = (char)(0xF0 | (cp >> 18));
+        out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[3] = (char)(0x80 | (cp & 0x3F));
+        n = 4;
+    }
+    for (size_t i = 0; i < n; i++) {
+        esp_err_t err = append_byte(p, out[i]);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+// 键结束，查找对应字段
+static void finish_key(body_parser_t *p)
+{
+    p->key[p->key_len] = '\0';
+    p->field = -1;
+    if (p->key_overflow) {
+        return;
+    }
+    for (size_t i = 0; i < p->field_count; i++) {
+        if (strcmp(p->fields[i].key, p->key) == 0) {
+            p->field = (int)i;
+            return;
+        }
+    }
+}
+
+// 字符串值结束
+static void finish_value(body_parser_t *p)
+{
+    if (p->field < 0) {
+        return;
+    }
+    body_field_t *f = &p->fields[p->field];
+    f->buf[p->value_len] = '\0';
+    f->present = true;
+    if (!p->record_dirty) {
+        p->record_dirty = true;
+        p->record_depth = p->depth;
+    }
+    p->field = -1;
+}
+
+static esp_err_t json_push(body_parser_t *p, bool is_array)
+{
+    if (p->depth >= BODY_PARSER_DEPTH_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (is_array) {
+        p->array_bits |= (1UL << p->depth);
+    } else {
+        p->array_bits &= ~(1UL << p->depth);
+    }
+    p->depth++;
+    return ESP_OK;
+}
+
+static bool json_top_is_array(const body_parser_t *p)
+{
+    return p->depth > 0 && (p->array_bits & (1UL << (p->depth - 1)));
+}
+
+// 闭合当前容器，对象闭合时提交记录
+static esp_err_t json_pop(body_parser_t *p)
+{
+    esp_err_t err = ESP_OK;
+    // 只有记录所在的对象闭合时才提交，嵌套的无关对象不影响
+    if (!json_top_is_array(p) && p->depth == p->record_depth) {
+        err = emit_record(p);
+    }
+    p->depth--;
+    p->state = p->depth == 0 ? J_DONE : J_AFTER_VALUE;
+    return err;
+}
+
+static esp_err_t json_value_start(body_parser_t *p, char c)
+{
+    switch (c) {
+    case '{':
+    case '[':
+        // 关注的字段只接受字符串、数字或字面量，避免从数组或对象中取出意外的值
+        if (p->field >= 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        p->state = c == '{' ? J_OBJ_FIRST : J_ARR_FIRST;
+        return json_push(p, c == '[');
+    case '"':
+        begin_token(p, false);
+        p->state = J_STRING;
+        return ESP_OK;
+    default:
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            // 数字按原文提取，由调用者自行转换
+            begin_token(p, false);
+            p->state = J_NUMBER;
+            p->number_state = c == '-' ? N_SIGN : c == '0' ? N_ZERO : N_INT;
+            return append_byte(p, c);
+        }
+        p->literal = c == 't' ? "true" : c == 'f' ? "false" : c == 'n' ? "null" : NULL;
+        if (p->literal != NULL) {
+            p->field = -1;  // 布尔和null不提取
+            p->literal_pos = 1;
+            p->state = J_WORD;
+            return ESP_OK;
+        }
+        return ESP_ERR_INVALID_ARG;
+    }
+}
+
+static esp_err_t json_step(body_parser_t *p, char c)
+{
+    switch (p->state) {
+    case J_VALUE:
+        if (is_space(c)) return ESP_OK;
+        return json_value_start(p, c);
+
+    case J_OBJ_FIRST:
+    case J_OBJ_KEY:
+        if (is_space(c)) return ESP_OK;
+        if (c == '}' && p->state == J_OBJ_FIRST) return json_pop(p);
+        if (c != '"') return ESP_ERR_INVALID_ARG;
+        begin_token(p, true);
+        p->state = J_STRING;
+        return ESP_OK;
+
+    case J_COLON:
+        if (is_space(c)) return ESP_OK;
+        if (c != ':') return ESP_ERR_INVALID_ARG;
+        p->state = J_VALUE;
+        return ESP_OK;
+
+    case J_ARR_FIRST:
+        if (is_space(c)) return ESP_OK;
+        if (c == ']') return json_pop(p);
+        return json_value_start(p, c);
+
+    case J_NUMBER:
+        if (is_number_char(c)) {
+            return number_next(&p->number_state, c) ? append_byte(p, c) : ESP_ERR_INVALID_ARG;
+        }
+        if (!number_complete(p->number_state)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        finish_value(p);
+        p->state = p->depth == 0 ? J_DONE : J_AFTER_VALUE;
+        return json_step(p, c);
+
+    case J_WORD:
+        if (p->literal[p->literal_pos] != '\0') {
+            return c == p->literal[p->literal_pos++] ? ESP_OK : ESP_ERR_INVALID_ARG;
+        }
+        p->state = p->depth == 0 ? J_DONE : J_AFTER_VALUE;
+        return json_step(p, c);
+
+    case J_AFTER_VALUE:
+        if (is_space(c)) return ESP_OK;
+        if (c == ',') {
+            p->state = json_top_is_array(p) ? J_VALUE : J_OBJ_KEY;
+            return ESP_OK;
+        }
+        if ((c == '}' && !json_top_is_array(p)) || (c == ']' && json_top_is_array(p))) {
+            return json_pop(p);
+        }
+        return ESP_ERR_INVALID_ARG;
+
+    case J_STRING:
+        if (c == '"') {
+            if (p->in_key) {
+                finish_key(p);
+                p->state = J_COLON;
+                // 关注的字段出现在另一层对象中，已收集的字段属于外层对象，先单独提交
+                if (p->field >= 0 && p->record_dirty && p->record_depth != p->depth) {
+                    int field = p->field;
+                    esp_err_t err = emit_record(p);
+                    p->field = field;
+                    return err;
+                }
+            } else {
+                finish_value(p);
+                p->state = p->depth == 0 ? J_DONE : J_AFTER_VALUE;
+            }
+            return ESP_OK;
+        }
+        if (c == '\\') {
+            p->state = J_STRING_ESC;
+            return ESP_OK;
+        }
+        if ((unsigned char)c < 0x20) return ESP_ERR_INVALID_ARG;
+        return append_byte(p, c);
+
+    case J_STRING_ESC:
+        p->state = J_STRING;
+        switch (c) {
+        case '"': case '\\': case '/': return append_byte(p, c);
+        case 'b': return append_byte(p, '\b');
+        case 'f': return append_byte(p, '\f');
+        case 'n': return append_byte(p, '\n');
+        case 'r': return append_byte(p, '\r');
+        case 't': return append_byte(p, '\t');
+        case 'u':
+            p->code_point = 0;
+            p->hex_left = 4;
+            p->state = J_STRING_HEX;
+            return ESP_OK;
+        default:
+            return ESP_ERR_INVALID_ARG;
+        }
+
+    case J_STRING_HEX: {
+        int v = hex_value(c);
+        if (v < 0) return ESP_ERR_INVALID_ARG;
+        p->code_point = (p->code_point << 4) | (uint32_t)v;
+        if (--p->hex_left > 0) return ESP_OK;
+        p->state = J_STRING;
+        uint32_t cp = p->code_point;
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+            p->high_surrogate = (uint16_t)cp;  // 等待低位代理
+            return ESP_OK;
+        }
+        if (cp >= 0xDC00 && cp <= 0xDFFF && p->high_surrogate) {
+            cp = 0x10000 + (((uint32_t)p->high_surrogate - 0xD800) << 10) + (cp - 0xDC00);
+        } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+            cp = 0xFFFD;
+        }
+        p->high_surrogate = 0;
+        return append_utf8(p, cp);
+    }
+
+    case J_DONE:
+        return is_space(c) ? ESP_OK : ESP_ERR_INVALID_ARG;
+
+    default:
+        return ESP_ERR_INVALID_STATE;
+    }
+}
+
+static esp_err_t form_step(body_parser_t *p, char c)
+{
+    switch (p->state) {
+    case F_KEY:
+        if (c == '=') {
+            finish_key(p);
+            // 同一记录中再次出现的键表示下一条记录开始
+            if (p->field >= 0 && p->fields[p->field].present) {
+                int field = p->field;
+                esp_err_t err = emit_record(p);
+                if (err != ESP_OK) return err;
+                p->field = field;
+            }
+            p->in_key = false;
+            p->value_len = 0;
+            p->state = F_VALUE;
+            return ESP_OK;
+        }
+        if (c == '&') {
+            begin_token(p, true);  // 没有值的键，忽略
+            return ESP_OK;
+        }
+        break;
+
+    case F_VALUE:
+        if (c == '&') {
+            finish_value(p);
+            begin_token(p, true);
+            p->state = F_KEY;
+            return ESP_OK;
+        }
+        break;
+
+    case F_HEX: {
+        int v = hex_value(c);
+        if (v < 0) return ESP_ERR_INVALID_ARG;
+        p->code_point = (p->code_point << 4) | (uint32_t)v;
+        if (--p->hex_left > 0) return ESP_OK;
+        p->state = p->in_key ? F_KEY : F_VALUE;
+        return append_byte(p, (char)p->code_point);
+    }
+
+    default:
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (c == '%') {
+        p->code_point = 0;
+        p->hex_left = 2;
+        p->state = F_HEX;
+        return ESP_OK;
+    }
+    return append_byte(p, c == '+' ? ' ' : c);
+}
+
+void body_parser_init(body_parser_t *p, body_format_t format,
+                      body_field_t *fields, size_t field_count,
+                      body_record_cb_t on_record, void *ctx)
+{
+    memset(p, 0, sizeof(*p));
+    p->format = format;
+    p->fields = fields;
+    p->field_count = field_count;
+    p->on_record = on_record;
+    p->ctx = ctx;
+    p->field = -1;
+    reset_fields(p);
+    if (format == BODY_FORMAT_FORM) {
+        begin_token(p, true);
+        p->state = F_KEY;
+    } else {
+        p->state = J_VALUE;
+    }
+}
+
+esp_err_t body_parser_feed(body_parser_t *p, const char *data, size_t len)
+{
+    if (p->error != ESP_OK) {
+        return p->error;
+    }
+    for (size_t i = 0; i < len; i++) {
+        esp_err_t err = p->format == BODY_FORMAT_FORM ? form_step(p, data[i]) : json_step(p, data[i]);
+        if (err != ESP_OK) {
+            p->error = err;
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t body_parser_finish(body_parser_t *p)
+{
+    if (p->error != ESP_OK) {
+        return p->error;
+    }
+    if (p->format == BODY_FORMAT_FORM) {
+        if (p->state == F_HEX) {
+            return p->error = ESP_ERR_INVALID_ARG;
+        }
+        if (p->state == F_VALUE) {
+            finish_value(p);
+        }
+        return p->error = emit_record(p);
+    }
+    if (p->state == J_NUMBER && p->depth == 0 && number_complete(p->number_state)) {
+        finish_value(p);
+        p->state = J_DONE;
+    }
+    if (p->state == J_WORD && p->depth == 0 && p->literal[p->literal_pos] == '\0') {
+        p->state = J_DONE;
+    }
+    if (p->state != J_DONE) {
+        return p->error = ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,85 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 10:00:00
+ * @Description: 流式请求体解析器
+ *
+ * 按 httpd_req_recv 收到的分块逐字节解析 JSON 或 application/x-www-form-urlencoded，
+ * 只提取调用者声明的字符串和数字字段(数字保留原文，须符合JSON数字语法)，不构建语法树，内存占用固定。
+ * 关注的字段的值为对象或数组时视为格式错误，true/false/null视为未出现。
+ * 每当一组字段完成(JSON对象闭合或表单中出现重复键)时回调一次，因此可以处理
+ * {"ssid":..} / [{..},{..}] / {"networks":[{..},{..}]} / ssid=a&password=b&ssid=c 等批量写法。
+ * JSON中每个字段归属直接包含它的对象，外层对象的字段与嵌套对象中的字段分属不同记录，
+ * 与键的先后顺序无关。
+ */
+
+#ifndef _BODY_PARSER_H_
+#define _BODY_PARSER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#define BODY_PARSER_KEY_MAX   24   // 关注的字段名最大长度
+#define BODY_PARSER_DEPTH_MAX 16   // JSON最大嵌套深度
+
+typedef enum {
+    BODY_FORMAT_JSON,
+    BODY_FORMAT_FORM,
+} body_format_t;
+
+// 需要提取的字段，buf由调用者提供
+typedef struct {
+    const char *key;
+    char *buf;
+    size_t size;       // 含结尾'\0'
+    bool present;      // 当前记录中是否出现
+} body_field_t;
+
+/*
+ * 一条记录解析完成
+ * 返回非ESP_OK时终止解析，并由 body_parser_feed/finish 原样返回
+ * 不提供回调时不按记录清空字段，解析结束后fields中保留各字段最后一次出现的值
+ */
+typedef esp_err_t (*body_record_cb_t)(body_field_t *fields, size_t count, void *ctx);
+
+typedef struct {
+    body_format_t format;
+    body_field_t *fields;
+    size_t field_count;
+    body_record_cb_t on_record;
+    void *ctx;
+
+    uint8_t state;
+    uint8_t depth;
+    uint32_t array_bits;        // 第n层为数组时第n位为1
+    bool in_key;
+    char key[BODY_PARSER_KEY_MAX + 1];
+    size_t key_len;
+    bool key_overflow;
+    int field;                  // 当前值对应的字段下标，-1表示忽略
+    size_t value_len;
+    uint32_t code_point;        // \uXXXX 或 %XX 累加值
+    uint8_t hex_left;
+    uint16_t high_surrogate;
+    const char *literal;        // 正在匹配的true/false/null
+    uint8_t literal_pos;
+    uint8_t number_state;       // 数字语法中的位置
+    bool record_dirty;          // 当前记录已有字段
+    uint8_t record_depth;       // 当前记录所在的对象层级，即记录中字段所在的路径
+    size_t records;             // 已回调的记录数
+    esp_err_t error;
+} body_parser_t;
+
+// 初始化解析器并清空字段
+void body_parser_init(body_parser_t *p, body_format_t format,
+                      body_field_t *fields, size_t field_count,
+                      body_record_cb_t on_record, void *ctx);
+
+// 喂入一段数据，可多次调用
+esp_err_t body_parser_feed(body_parser_t *p, const char *data, size_t len);
+
+// 数据结束，检查语法完整并回调最后一条记录
+esp_err_t body_parser_finish(body_parser_t *p);
+
+#endif /* _BODY_PARSER_H_ */
@@ -0,0 +1,95 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 14:00:00
+ * @Description: 强制门户实现
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_http_server.h"
+#include "dhcpserver/dhcpserver.h"
+#include "http_server.h"
+#include "dns_server.h"
+#include "captive_portal.h"
+
+static const char *TAG = "captive_portal";
+
+#define PORTAL_PORT        80
+#define PORTAL_CTRL_PORT   32769   // 与主服务器的控制端口错开
+
+static httpd_handle_t s_portal = NULL;
+static char s_portal_url[40];      // 启动时按AP地址预先生成
+
+// 固定的重定向响应，无需读取请求内容
+static esp_err_t portal_redirect_handler(httpd_req_t *req)
+{
+    httpd_resp_set_status(req, "302 Found");
+    httpd_resp_set_hdr(req, "Location", s_portal_url);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    return httpd_resp_send(req, NULL, 0);
+}
+
+// 让连接到AP的设备使用本机作为DNS服务器
+static void offer_dns(esp_netif_t *ap_netif, const esp_netif_ip_info_t *ip_info)
+{
+    esp_netif_dns_info_t dns = {0};
+    dns.ip.u_addr.ip4.addr = ip_info->ip.addr;
+    dns.ip.type = ESP_IPADDR_TYPE_V4;
+    dhcps_offer_t offer = OFFER_DNS;
+
+    esp_netif_dhcps_stop(ap_netif);
+    esp_netif_dhcps_option(ap_netif, ESP_NETIF_OP_SET, ESP_NETIF_DOMAIN_NAME_SERVER, &offer, sizeof(offer));
+    esp_netif_set_dns_info(ap_netif, ESP_NETIF_DNS_MAIN, &dns);
+    esp_netif_dhcps_start(ap_netif);
+}
+
+esp_err_t captive_portal_start(void)
+{
+    esp_netif_t *ap_netif = esp_netif_get_handle_from_ifkey("WIFI_AP_DEF");
+    esp_netif_ip_info_t ip_info;
+    if (ap_netif == NULL || esp_netif_get_ip_info(ap_netif, &ip_info) != ESP_OK) {
+        ESP_LOGE(TAG, "获取AP地址失败");
+        return ESP_FAIL;
+    }
+
+    snprintf(s_portal_url, sizeof(s_portal_url), "http://" IPSTR ":%d/",
+             IP2STR(&ip_info.ip), WEB_SERVER_PORT);
+    offer_dns(ap_netif, &ip_info);
+
+    esp_err_t err = dns_server_start(ip_info.ip.addr);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "启动DNS服务失败: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    // 80端口只做重定向，占用尽量少的socket和栈
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = PORTAL_PORT;
+    config.ctrl_port = PORTAL_CTRL_PORT;
+    config.max_open_sockets = 2;
+    config.stack_size = 3072;
+    config.lru_purge_enable = true;
+    config.max_uri_handlers = 1;
+    config.uri_match_fn = httpd_uri_match_wildcard;
+
+    err = httpd_start(&s_portal, &config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "启动门户服务失败: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    // 各系统的联网检测(Android的/generate_204、iOS的/hotspot-detect.html、
+    // Windows的/connecttest.txt等)和其他任意路径一样，都重定向到配网页面
+    httpd_uri_t uri = {
+        .uri      = "/*",
+        .method   = HTTP_GET,
+        .handler  = portal_redirect_handler,
+        .user_ctx = NULL,
+    };
+    httpd_register_uri_handler(s_portal, &uri);
+
+    ESP_LOGI(TAG, "强制门户已启动，重定向到 %s", s_portal_url);
+    return ESP_OK;
+}
@@ -0,0 +1,18 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 14:00:00
+ * @Description: 强制门户
+ *
+ * 手机连上SoftAP后，DHCP下发本机为DNS服务器，DNS把所有域名解析到AP地址，
+ * 80端口对各系统的联网检测URL直接返回重定向，系统随即弹出配网页面。
+ */
+
+#ifndef _CAPTIVE_PORTAL_H_
+#define _CAPTIVE_PORTAL_H_
+
+#include "esp_err.h"
+
+// 启动DNS服务和80端口重定向服务，需在WiFi和主Web服务器启动之后调用
+esp_err_t captive_portal_start(void);
+
+#endif /* _CAPTIVE_PORTAL_H_ */
@@ -0,0 +1,132 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 12:00:00
+ * @Description: 流式CBOR编码器实现 (RFC 8949)
+ */
+
+#include <string.h>
+#include "cbor_writer.h"
+
+// 主类型
+#define CBOR_UINT    (0 << 5)
+#define CBOR_NEGINT  (1 << 5)
+#define CBOR_TEXT    (3 << 5)
+#define CBOR_ARRAY   (4 << 5)
+#define CBOR_MAP     (5 << 5)
+#define CBOR_SIMPLE  (7 << 5)
+
+#define CBOR_FALSE   20
+#define CBOR_TRUE    21
+
+static void flush_buffer(cbor_writer_t *w)
+{
+    if (w->error == ESP_OK && w->len > 0) {
+        w->error = w->flush ? w->flush(w->ctx, w->buf, w->len) : ESP_ERR_NO_MEM;
+    }
+    w->len = 0;
+}
+
+static void write_bytes(cbor_writer_t *w, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    while (len > 0 && w->error == ESP_OK) {
+        if (w->len == w->size) {
+            flush_buffer(w);
+            continue;
+        }
+        size_t n = w->size - w->len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(w->buf + w->len, p, n);
+        w->len += n;
+        p += n;
+        len -= n;
+    }
+}
+
+// 写入数据项头部，参数按最短形式编码
+static void write_head(cbor_writer_t *w, uint8_t major, uint64_t value)
+{
+    uint8_t head[9];
+    size_t n;
+    if (value < 24) {
+        head[0] = major | (uint8_t)value;
+        n = 1;
+    } else if (value <= 0xFF) {
+        head[0] = major | 24;
+        head[1] = (uint8_t)value;
+        n = 2;
+    } else if (value <= 0xFFFF) {
+        head[0] = major | 25;
+        head[1] = (uint8_t)(value >> 8);
+        head[2] = (uint8_t)value;
+        n = 3;
+    } else if (value <= 0xFFFFFFFFULL) {
+        head[0] = major | 26;
+        for (int i = 0; i < 4; i++) {
+            head[1 + i] = (uint8_t)(value >> (24 - 8 * i));
+        }
+        n = 5;
+    } else {
+        head[0] = major | 27;
+        for (int i = 0; i < 8; i++) {
+            head[1 + i] = (uint8_t)(value >> (56 - 8 * i));
+        }
+        n = 9;
+    }
+    write_bytes(w, head, n);
+}
+
+void cbor_writer_init(cbor_writer_t *w, uint8_t *buf, size_t size, cbor_flush_fn_t flush, void *ctx)
+{
+    w->buf = buf;
+    w->size = size;
+    w->len = 0;
+    w->flush = flush;
+    w->ctx = ctx;
+    w->error = ESP_OK;
+}
+
+void cbor_put_uint(cbor_writer_t *w, uint64_t value)
+{
+    write_head(w, CBOR_UINT, value);
+}
+
+void cbor_put_int(cbor_writer_t *w, int64_t value)
+{
+    if (value >= 0) {
+        write_head(w, CBOR_UINT, (uint64_t)value);
+    } else {
+        write_head(w, CBOR_NEGINT, (uint64_t)(-1 - value));
+    }
+}
+
+void cbor_put_text(cbor_writer_t *w, const char *str)
+{
+    size_t len = strlen(str);
+    write_head(w, CBOR_TEXT, len);
+    write_bytes(w, str, len);
+}
+
+void cbor_put_bool(cbor_writer_t *w, bool value)
+{
+    uint8_t b = CBOR_SIMPLE | (value ? CBOR_TRUE : CBOR_FALSE);
+    write_bytes(w, &b, 1);
+}
+
+void cbor_put_array(cbor_writer_t *w, size_t count)
+{
+    write_head(w, CBOR_ARRAY, count);
+}
+
+void cbor_put_map(cbor_writer_t *w, size_t count)
+{
+    write_head(w, CBOR_MAP, count);
+}
+
+esp_err_t cbor_writer_finish(cbor_writer_t *w)
+{
+    flush_buffer(w);
+    return w->error;
+}
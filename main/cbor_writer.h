@@ -0,0 +1,42 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 12:00:00
+ * @Description: 流式CBOR编码器
+ *
+ * 直接把CBOR数据项写入调用者提供的定长缓冲区，缓冲区满时通过flush回调输出
+ * (例如 httpd_resp_send_chunk)，不在堆上构建任何中间结构。
+ * 只实现接口需要的类型：无符号/负整数、文本串、数组、映射、布尔。
+ */
+
+#ifndef _CBOR_WRITER_H_
+#define _CBOR_WRITER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+typedef esp_err_t (*cbor_flush_fn_t)(void *ctx, const uint8_t *data, size_t len);
+
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+    size_t len;
+    cbor_flush_fn_t flush;
+    void *ctx;
+    esp_err_t error;    // 第一次出错后后续写入全部忽略
+} cbor_writer_t;
+
+void cbor_writer_init(cbor_writer_t *w, uint8_t *buf, size_t size, cbor_flush_fn_t flush, void *ctx);
+
+void cbor_put_uint(cbor_writer_t *w, uint64_t value);
+void cbor_put_int(cbor_writer_t *w, int64_t value);
+void cbor_put_text(cbor_writer_t *w, const char *str);
+void cbor_put_bool(cbor_writer_t *w, bool value);
+void cbor_put_array(cbor_writer_t *w, size_t count);
+void cbor_put_map(cbor_writer_t *w, size_t count);
+
+// 输出缓冲区剩余数据，返回整个编码过程中的第一个错误
+esp_err_t cbor_writer_finish(cbor_writer_t *w);
+
+#endif /* _CBOR_WRITER_H_ */
@@ -0,0 +1,74 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 22:00:00
+ * @Description: SoftAP信道拥塞评分实现
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include "channel_plan.h"
+
+void channel_plan_reset(channel_plan_t *plan)
+{
+    memset(plan, 0, sizeof(*plan));
+}
+
+void channel_plan_add(channel_plan_t *plan, uint8_t channel, int8_t rssi)
+{
+    if (channel < 1 || channel > CHANNEL_PLAN_MAX) {
+        return;
+    }
+    int strength = rssi;
+    if (strength < CHANNEL_PLAN_FLOOR_DBM) {
+        strength = CHANNEL_PLAN_FLOOR_DBM;
+    } else if (strength > CHANNEL_PLAN_CEIL_DBM) {
+        strength = CHANNEL_PLAN_CEIL_DBM;
+    }
+    uint32_t cost = CHANNEL_PLAN_AP_COST + (uint32_t)(strength - CHANNEL_PLAN_FLOOR_DBM);
+
+    plan->aps[channel]++;
+    // 同信道按SPAN+1倍计，每远一个信道少一倍
+    for (int d = -CHANNEL_PLAN_SPAN; d <= CHANNEL_PLAN_SPAN; d++) {
+        int ch = channel + d;
+        if (ch >= 1 && ch <= CHANNEL_PLAN_MAX) {
+            plan->score[ch] += cost * (uint32_t)(CHANNEL_PLAN_SPAN + 1 - (d < 0 ? -d : d));
+        }
+    }
+}
+
+static bool is_preferred(uint8_t channel)
+{
+    return channel == 1 || channel == 6 || channel == 11;
+}
+
+uint8_t channel_plan_best(const channel_plan_t *plan, uint8_t max_channel)
+{
+    if (max_channel > CHANNEL_PLAN_MAX) {
+        max_channel = CHANNEL_PLAN_MAX;
+    }
+    uint8_t best = 1;
+    for (uint8_t ch = 2; ch <= max_channel; ch++) {
+        if (plan->score[ch] < plan->score[best] ||
+            (plan->score[ch] == plan->score[best] && is_preferred(ch) && !is_preferred(best))) {
+            best = ch;
+        }
+    }
+    return best;
+}
+
+uint8_t channel_plan_choose(const channel_plan_t *plan, uint8_t current,
+                            uint8_t max_channel, uint8_t hysteresis_pct)
+{
+    uint8_t best = channel_plan_best(plan, max_channel);
+    if (current < 1 || current > max_channel || current > CHANNEL_PLAN_MAX) {
+        return best;
+    }
+    if (hysteresis_pct > 100) {
+        hysteresis_pct = 100;
+    }
+    // 分数最多几万，乘100不会溢出
+    if (plan->score[best] * 100 < plan->score[current] * (100u - hysteresis_pct)) {
+        return best;
+    }
+    return current;
+}
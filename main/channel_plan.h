@@ -0,0 +1,40 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 22:00:00
+ * @Description: SoftAP信道拥塞评分
+ *
+ * 把一次扫描到的AP按主信道和RSSI累加到各信道的拥塞分上：每个AP计基础分加信号强度分，
+ * 2.4GHz的20MHz信道与相距CHANNEL_PLAN_SPAN以内的信道都有重叠，按距离递减计入相邻信道。
+ * 分数越低越空闲，同分时优先1/6/11。只依赖标准C，可以在主机上用记录的扫描结果回放。
+ */
+
+#ifndef _CHANNEL_PLAN_H_
+#define _CHANNEL_PLAN_H_
+
+#include <stdint.h>
+
+#define CHANNEL_PLAN_MAX        14      // 记录到14信道，14信道的AP也会影响10~13
+#define CHANNEL_PLAN_SPAN       4       // 相距4个信道以内有频谱重叠
+#define CHANNEL_PLAN_AP_COST    10      // 每个AP的基础分，信号再弱也占用空口
+#define CHANNEL_PLAN_FLOOR_DBM  (-95)   // 低于此RSSI只计基础分
+#define CHANNEL_PLAN_CEIL_DBM   (-30)   // 高于此RSSI按此计算
+
+typedef struct {
+    uint32_t score[CHANNEL_PLAN_MAX + 1];   // 下标为信道号，0不用
+    uint8_t aps[CHANNEL_PLAN_MAX + 1];      // 主信道在该信道上的AP数
+} channel_plan_t;
+
+void channel_plan_reset(channel_plan_t *plan);
+
+// 累加一个扫描到的AP，信道超出范围时忽略
+void channel_plan_add(channel_plan_t *plan, uint8_t channel, int8_t rssi);
+
+// 1~max_channel中分数最低的信道
+uint8_t channel_plan_best(const channel_plan_t *plan, uint8_t max_channel);
+
+// 最佳信道比当前信道至少空闲hysteresis_pct(百分比)才切换，返回应使用的信道；
+// current为0或超出范围时直接返回最佳信道
+uint8_t channel_plan_choose(const channel_plan_t *plan, uint8_t current,
+                            uint8_t max_channel, uint8_t hysteresis_pct);
+
+#endif /* _CHANNEL_PLAN_H_ */
@@ -0,0 +1,235 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 22:00:00
+ * @Description: SoftAP信道自动选择实现
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_event.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "wifi_manager.h"
+#include "provision_store.h"
+#include "channel_planner.h"
+
+static const char *TAG = "channel_planner";
+
+#define PLANNER_TASK_STACK   3072
+#define PLANNER_TASK_PRIO    2
+#define PLANNER_BOOT_DELAY   1000   // ms，等STA_START事件确定STA是否要连接
+#define PLANNER_RETRY_DELAY  10000  // ms，STA正在连接或扫描冲突时稍后再试
+#define PLANNER_HYSTERESIS   25     // 百分比，重新评估时至少空闲这么多才切换
+#define PLANNER_DWELL_MIN    30     // ms，每个信道的主动扫描时间，13个信道约1秒
+#define PLANNER_DWELL_MAX    60
+
+static SemaphoreHandle_t s_lock = NULL;
+static channel_planner_status_t s_status;
+static wifi_ap_record_t s_scan[CHANNEL_SURVEY_MAX];
+
+static uint32_t now_s(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+// 修改SoftAP配置中的信道，已连接的手机会断开后在新信道上重连
+static esp_err_t set_ap_channel(uint8_t channel, channel_mode_t mode)
+{
+    wifi_config_t cfg;
+    esp_err_t err = esp_wifi_get_config(WIFI_IF_AP, &cfg);
+    if (err == ESP_OK && cfg.ap.channel != channel) {
+        cfg.ap.channel = channel;
+        err = esp_wifi_set_config(WIFI_IF_AP, &cfg);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "设置SoftAP信道%d失败: %s", channel, esp_err_to_name(err));
+        return err;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_status.channel != channel) {
+        s_status.channel = channel;
+        s_status.switches++;
+    }
+    s_status.mode = mode;
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
+
+// STA连上路由器时射频已经在路由器信道上，同步AP配置，断开重连期间AP也不会换回原信道
+static void planner_event_handler(void *arg, esp_event_base_t event_base,
+                                  int32_t event_id, void *event_data)
+{
+    wifi_event_sta_connected_t *event = (wifi_event_sta_connected_t *)event_data;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    uint8_t current = s_status.channel;
+    xSemaphoreGive(s_lock);
+    if (event->channel != current) {
+        ESP_LOGI(TAG, "STA连接在信道%d，SoftAP跟随", event->channel);
+    }
+    set_ap_channel(event->channel, CHANNEL_MODE_HOME);
+}
+
+// 扫描全部信道并重新计算评分。扫描结果按RSSI从强到弱排列，
+// 超出CHANNEL_SURVEY_MAX的都是最弱的AP，对评分影响很小
+static bool survey(void)
+{
+    wifi_scan_config_t scan_config = {
+        .ssid = NULL,
+        .bssid = NULL,
+        .channel = 0,
+        .show_hidden = true,    // 隐藏网络同样占用空口
+        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
+        .scan_time.active.min = PLANNER_DWELL_MIN,
+        .scan_time.active.max = PLANNER_DWELL_MAX,
+    };
+    // HTTP扫描或漫游扫描进行中、STA正在连接时都会失败，稍后再试
+    if (!wifi_manager_scan_lock(0)) {
+        return false;
+    }
+    uint16_t count = CHANNEL_SURVEY_MAX;
+    esp_err_t err = esp_wifi_scan_start(&scan_config, true);
+    if (err == ESP_OK) {
+        err = esp_wifi_scan_get_ap_records(&count, s_scan);
+    }
+    wifi_manager_scan_unlock();
+    if (err != ESP_OK) {
+        return false;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    channel_plan_reset(&s_status.plan);
+    for (uint16_t i = 0; i < count; i++) {
+        channel_plan_add(&s_status.plan, s_scan[i].primary, s_scan[i].rssi);
+        s_status.survey[i].channel = s_scan[i].primary;
+        s_status.survey[i].rssi = s_scan[i].rssi;
+    }
+    s_status.survey_count = (uint8_t)count;
+    s_status.surveyed_at = now_s();
+    s_status.surveys++;
+    xSemaphoreGive(s_lock);
+    return true;
+}
+
+// 评估一次，返回到下一次评估前需要等待的毫秒数，0表示按配置的周期
+static uint32_t evaluate(void)
+{
+    wifi_state_t state = wifi_manager_get_state();
+    if (state == WIFI_STATE_CONNECTED) {
+        // 事件可能早于本任务启动，这里再同步一次
+        wifi_ap_record_t ap_info;
+        if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
+            set_ap_channel(ap_info.primary, CHANNEL_MODE_HOME);
+        }
+        return 0;
+    }
+    if (state == WIFI_STATE_CONNECTING) {
+        return PLANNER_RETRY_DELAY;  // 扫描会打断连接，等连接结果
+    }
+
+    // 切换信道会让热点上的手机掉线，配网过程中不动
+    wifi_sta_list_t sta_list;
+    if (esp_wifi_ap_get_sta_list(&sta_list) == ESP_OK && sta_list.num > 0) {
+        return 0;
+    }
+    if (!survey()) {
+        return PLANNER_RETRY_DELAY;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    uint8_t current = s_status.channel;
+    // 开机第一次扫描时热点刚启动，不需要迟滞
+    uint8_t hysteresis = s_status.surveys == 1 ? 0 : PLANNER_HYSTERESIS;
+    uint8_t next = channel_plan_choose(&s_status.plan, current, s_status.max_channel, hysteresis);
+    uint32_t current_score = s_status.plan.score[current];
+    uint32_t next_score = s_status.plan.score[next];
+    xSemaphoreGive(s_lock);
+
+    if (next != current) {
+        ESP_LOGI(TAG, "信道%d拥塞分%lu，信道%d为%lu，SoftAP切换到信道%d",
+                 current, (unsigned long)current_score, next, (unsigned long)next_score, next);
+    }
+    set_ap_channel(next, CHANNEL_MODE_AUTO);
+    return 0;
+}
+
+static void channel_planner_task(void *arg)
+{
+    vTaskDelay(pdMS_TO_TICKS(PLANNER_BOOT_DELAY));
+    while (1) {
+        uint32_t delay_ms = evaluate();
+        if (delay_ms != 0) {
+            vTaskDelay(pdMS_TO_TICKS(delay_ms));
+            continue;
+        }
+#if CONFIG_AP_CHANNEL_RECHECK_INTERVAL > 0
+        // 按秒换算节拍数，避免毫秒乘节拍率溢出
+        vTaskDelay((TickType_t)CONFIG_AP_CHANNEL_RECHECK_INTERVAL * 60 * configTICK_RATE_HZ);
+#else
+        // 只在开机时选择，之后由事件跟随STA信道
+        break;
+#endif
+    }
+    vTaskDelete(NULL);
+}
+
+esp_err_t channel_planner_start(void)
+{
+    if (s_lock != NULL) {
+        return ESP_OK;
+    }
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    wifi_config_t cfg;
+    if (esp_wifi_get_config(WIFI_IF_AP, &cfg) == ESP_OK) {
+        s_status.channel = cfg.ap.channel;
+    }
+    wifi_country_t country;
+    s_status.max_channel = 13;
+    if (esp_wifi_get_country(&country) == ESP_OK && country.nchan > 0 &&
+        country.schan + country.nchan - 1 < s_status.max_channel) {
+        s_status.max_channel = country.schan + country.nchan - 1;
+    }
+
+    // 批量配网指定了信道时尊重设置
+    provision_data_t provision;
+    if (provision_store_load(&provision) == ESP_OK && provision.settings.ap_channel != 0) {
+        s_status.mode = CHANNEL_MODE_FIXED;
+        ESP_LOGI(TAG, "SoftAP信道由配置固定为%d", provision.settings.ap_channel);
+        return ESP_OK;
+    }
+    s_status.mode = CHANNEL_MODE_AUTO;
+
+    esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, planner_event_handler, NULL);
+
+    if (xTaskCreate(channel_planner_task, "channel_plan", PLANNER_TASK_STACK, NULL, PLANNER_TASK_PRIO, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t channel_planner_snapshot(channel_planner_status_t *out)
+{
+    if (s_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *out = s_status;
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
+
+const char *channel_planner_mode_name(uint8_t mode)
+{
+    switch (mode) {
+    case CHANNEL_MODE_FIXED: return "fixed";
+    case CHANNEL_MODE_HOME:  return "home";
+    default:                 return "auto";
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 22:00:00
+ * @Description: SoftAP信道自动选择
+ *
+ * 开机后快速扫描一遍，把SoftAP移到最空闲的信道；STA连上路由器后跟随其信道，
+ * 避免APSTA共用的射频在两个信道间来回切换。STA未连接且热点上没有手机时定期重新评估，
+ * 明显更空闲才切换。批量配网指定了ap_channel时不做自动选择。
+ */
+
+#ifndef _CHANNEL_PLANNER_H_
+#define _CHANNEL_PLANNER_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "channel_plan.h"
+
+#define CHANNEL_SURVEY_MAX  24      // 保留的扫描结果数
+
+// 信道来源
+typedef enum {
+    CHANNEL_MODE_FIXED,     // 批量配网指定
+    CHANNEL_MODE_AUTO,      // 按扫描结果选择
+    CHANNEL_MODE_HOME,      // 跟随STA连接的路由器
+} channel_mode_t;
+
+typedef struct {
+    uint8_t channel;
+    int8_t rssi;
+} channel_survey_ap_t;
+
+typedef struct {
+    uint8_t channel;                // 当前SoftAP信道
+    uint8_t mode;                   // channel_mode_t
+    uint8_t max_channel;            // 国家码允许的最大信道
+    uint32_t surveyed_at;           // 最近一次扫描的时间(开机后秒数)，0为尚未扫描
+    uint32_t surveys;
+    uint32_t switches;              // 信道切换次数
+    channel_plan_t plan;            // 最近一次扫描的评分
+    uint8_t survey_count;
+    channel_survey_ap_t survey[CHANNEL_SURVEY_MAX];
+} channel_planner_status_t;
+
+// 启动信道选择任务，需在WiFi启动之后调用
+esp_err_t channel_planner_start(void);
+
+// 复制一份当前状态，供接口输出
+esp_err_t channel_planner_snapshot(channel_planner_status_t *out);
+
+const char *channel_planner_mode_name(uint8_t mode);
+
+#endif /* _CHANNEL_PLANNER_H_ */
@@ -0,0 +1,36 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 11:00:00
+ * @Description: 设备标识与固件信息实现
+ */
+
+#include <stdio.h>
+#include "esp_mac.h"
+#include "esp_app_desc.h"
+#include "wifi_manager.h"
+#include "device_info.h"
+
+static char s_device_id[DEVICE_ID_LEN];
+
+const char *device_info_get_id(void)
+{
+    if (s_device_id[0] == '\0') {
+        uint8_t mac[6] = {0};
+        esp_read_mac(mac, ESP_MAC_WIFI_SOFTAP);
+        snprintf(s_device_id, sizeof(s_device_id), "%02X%02X%02X%02X%02X%02X",
+                 mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    }
+    return s_device_id;
+}
+
+const char *device_info_get_fw_version(void)
+{
+    return esp_app_get_description()->version;
+}
+
+int device_info_format_json(char *buf, size_t len)
+{
+    return snprintf(buf, len, "\"id\":\"%s\",\"fw\":\"%s\",\"state\":\"%s\"",
+                    device_info_get_id(), device_info_get_fw_version(),
+                    wifi_manager_state_name(wifi_manager_get_state()));
+}
@@ -0,0 +1,26 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 11:00:00
+ * @Description: 设备标识与固件信息
+ */
+
+#ifndef _DEVICE_INFO_H_
+#define _DEVICE_INFO_H_
+
+#include <stddef.h>
+
+#define DEVICE_ID_LEN (12 + 1)  // SoftAP MAC的十六进制形式
+
+// 设备ID，首次调用时由SoftAP MAC生成并缓存
+const char *device_info_get_id(void);
+
+// 固件版本号
+const char *device_info_get_fw_version(void);
+
+/*
+ * 生成设备信息JSON片段(不含花括号)，供 /api/ping 等接口拼接
+ * 形如 "id":"246F28A1B2C3","fw":"1.0.0","state":"connected"
+ */
+int device_info_format_json(char *buf, size_t len);
+
+#endif /* _DEVICE_INFO_H_ */
@@ -0,0 +1,59 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 17:00:00
+ * @Description: 局域网设备发现报文处理实现
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include "discovery_packet.h"
+
+bool discovery_match_query(const uint8_t *pkt, size_t len, const char *device_id)
+{
+    const size_t prefix_len = sizeof(DISCOVERY_QUERY) - 1;
+    if (len < prefix_len || memcmp(pkt, DISCOVERY_QUERY, prefix_len) != 0) {
+        return false;
+    }
+
+    // 忽略末尾的换行，方便用nc等工具手工测试
+    while (len > prefix_len && (pkt[len - 1] == '\n' || pkt[len - 1] == '\r')) {
+        len--;
+    }
+    if (len == prefix_len) {
+        return true;
+    }
+    if (pkt[prefix_len] != ' ') {
+        return false;
+    }
+    const char *id = (const char *)pkt + prefix_len + 1;
+    size_t id_len = len - prefix_len - 1;
+    return id_len == strlen(device_id) && strncasecmp(id, device_id, id_len) == 0;
+}
+
+// 按内存中的字节顺序输出网络字节序地址
+static void format_ip(char *buf, size_t size, uint32_t ip)
+{
+    const uint8_t *b = (const uint8_t *)&ip;
+    if (ip == 0) {
+        buf[0] = '\0';
+        return;
+    }
+    snprintf(buf, size, "%u.%u.%u.%u", b[0], b[1], b[2], b[3]);
+}
+
+size_t discovery_build_reply(char *buf, size_t size, const discovery_info_t *info)
+{
+    char sta_ip[16];
+    char ap_ip[16];
+    format_ip(sta_ip, sizeof(sta_ip), info->sta_ip);
+    format_ip(ap_ip, sizeof(ap_ip), info->ap_ip);
+
+    int len = snprintf(buf, size,
+                       "{\"id\":\"%s\",\"ip\":\"%s\",\"ap_ip\":\"%s\",\"port\":%u,\"fw\":\"%s\",\"state\":\"%s\"}",
+                       info->id, sta_ip, ap_ip, info->port, info->fw, info->state);
+    if (len < 0 || (size_t)len >= size) {
+        return 0;
+    }
+    return (size_t)len;
+}
@@ -0,0 +1,38 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 17:00:00
+ * @Description: 局域网设备发现报文处理
+ *
+ * 客户端向广播地址或组播组发送 "ESPWIFI_DISCOVER"，可在后面跟一个空格和设备ID只查找指定设备，
+ * 每台设备单播回复一个JSON报文，包含设备ID、IP、端口、固件版本和配网状态。
+ * 只依赖标准C，主机端测试和回环应答见 tools/discovery_test.c。
+ */
+
+#ifndef _DISCOVERY_PACKET_H_
+#define _DISCOVERY_PACKET_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define DISCOVERY_QUERY        "ESPWIFI_DISCOVER"
+#define DISCOVERY_GROUP        "239.255.42.99"
+#define DISCOVERY_MAX_PACKET   192
+
+// 回复内容，IP为网络字节序，0表示没有地址
+typedef struct {
+    const char *id;
+    const char *fw;
+    const char *state;
+    uint32_t sta_ip;
+    uint32_t ap_ip;
+    uint16_t port;
+} discovery_info_t;
+
+// 报文是否为发现请求，带设备ID时只匹配本机
+bool discovery_match_query(const uint8_t *pkt, size_t len, const char *device_id);
+
+// 生成回复报文，返回长度，缓冲区不足时返回0
+size_t discovery_build_reply(char *buf, size_t size, const discovery_info_t *info);
+
+#endif /* _DISCOVERY_PACKET_H_ */
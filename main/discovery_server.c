@@ -0,0 +1,151 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 17:00:00
+ * @Description: 局域网设备发现服务实现
+ */
+
+#include <string.h>
+#include <errno.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_wifi.h"
+#include "lwip/sockets.h"
+#include "http_server.h"
+#include "device_info.h"
+#include "wifi_manager.h"
+#include "discovery_packet.h"
+#include "discovery_server.h"
+
+static const char *TAG = "discovery";
+
+#define DISCOVERY_TASK_STACK   3072
+#define DISCOVERY_TASK_PRIO    4
+
+static TaskHandle_t s_task = NULL;
+static volatile bool s_running = false;
+static volatile bool s_dirty = true;        // 地址变化后置位，下次请求时重新生成
+static char s_reply[DISCOVERY_MAX_PACKET];
+static size_t s_reply_len = 0;
+static wifi_state_t s_reply_state;          // 生成回复时的连接状态
+
+// 地址或连接状态变化，标记回复需要重新生成
+static void discovery_event_handler(void *arg, esp_event_base_t event_base,
+                                    int32_t event_id, void *event_data)
+{
+    s_dirty = true;
+}
+
+static uint32_t netif_ip(const char *ifkey)
+{
+    esp_netif_ip_info_t ip_info;
+    esp_netif_t *netif = esp_netif_get_handle_from_ifkey(ifkey);
+    if (netif == NULL || esp_netif_get_ip_info(netif, &ip_info) != ESP_OK) {
+        return 0;
+    }
+    return ip_info.ip.addr;
+}
+
+static void rebuild_reply(wifi_state_t state)
+{
+    discovery_info_t info = {
+        .id = device_info_get_id(),
+        .fw = device_info_get_fw_version(),
+        .state = wifi_manager_state_name(state),
+        .sta_ip = netif_ip("WIFI_STA_DEF"),
+        .ap_ip = netif_ip("WIFI_AP_DEF"),
+        .port = WEB_SERVER_PORT,
+    };
+    s_reply_len = discovery_build_reply(s_reply, sizeof(s_reply), &info);
+    s_reply_state = state;
+}
+
+static void discovery_task(void *arg)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "创建socket失败: errno %d", errno);
+        goto exit;
+    }
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(CONFIG_DISCOVERY_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        ESP_LOGE(TAG, "绑定端口%d失败: errno %d", CONFIG_DISCOVERY_PORT, errno);
+        goto exit;
+    }
+
+    // 组播是广播之外的补充，加入失败不影响广播发现
+    struct ip_mreq mreq = {0};
+    inet_aton(DISCOVERY_GROUP, &mreq.imr_multiaddr);
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        ESP_LOGW(TAG, "加入组播组失败: errno %d", errno);
+    }
+
+    // 设置接收超时，便于discovery_server_stop后退出循环
+    struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    ESP_LOGI(TAG, "发现服务已启动，端口%d", CONFIG_DISCOVERY_PORT);
+
+    uint8_t query[64];
+    while (s_running) {
+        struct sockaddr_in client;
+        socklen_t client_len = sizeof(client);
+        int len = recvfrom(sock, query, sizeof(query), 0, (struct sockaddr *)&client, &client_len);
+        if (len < 0 || !discovery_match_query(query, len, device_info_get_id())) {
+            continue;
+        }
+        // 发起连接、重试、切换凭据和切换模式都不一定伴随事件，每次直接比较当前状态
+        wifi_state_t state = wifi_manager_get_state();
+        if (s_dirty || state != s_reply_state) {
+            s_dirty = false;
+            rebuild_reply(state);
+        }
+        if (s_reply_len > 0) {
+            sendto(sock, s_reply, s_reply_len, 0, (struct sockaddr *)&client, client_len);
+        }
+    }
+
+exit:
+    if (sock >= 0) {
+        close(sock);
+    }
+    s_task = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t discovery_server_start(void)
+{
+    if (s_task != NULL) {
+        return ESP_OK;
+    }
+
+    esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, discovery_event_handler, NULL);
+    esp_event_handler_register(IP_EVENT, IP_EVENT_STA_LOST_IP, discovery_event_handler, NULL);
+    esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, discovery_event_handler, NULL);
+    esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, discovery_event_handler, NULL);
+
+    s_dirty = true;
+    s_running = true;
+    if (xTaskCreate(discovery_task, "discovery", DISCOVERY_TASK_STACK, NULL, DISCOVERY_TASK_PRIO, &s_task) != pdPASS) {
+        s_running = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void discovery_server_stop(void)
+{
+    s_running = false;
+    esp_event_handler_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP, discovery_event_handler);
+    esp_event_handler_unregister(IP_EVENT, IP_EVENT_STA_LOST_IP, discovery_event_handler);
+    esp_event_handler_unregister(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, discovery_event_handler);
+    esp_event_handler_unregister(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, discovery_event_handler);
+}
@@ -0,0 +1,21 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 17:00:00
+ * @Description: 局域网设备发现服务
+ *
+ * 在AP和STA两侧监听UDP广播和组播的发现请求，回复预先生成的报文，
+ * 仅在IP地址或连接状态变化时重新生成。
+ */
+
+#ifndef _DISCOVERY_SERVER_H_
+#define _DISCOVERY_SERVER_H_
+
+#include "esp_err.h"
+
+// 启动发现服务，需在WiFi和Web服务器启动之后调用
+esp_err_t discovery_server_start(void);
+
+// 停止发现服务
+void discovery_server_stop(void);
+
+#endif /* _DISCOVERY_SERVER_H_ */
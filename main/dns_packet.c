@@ -0,0 +1,93 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 14:00:00
+ * @Description: 强制门户DNS报文处理实现 (RFC 1035)
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include "dns_packet.h"
+
+#define DNS_HEADER_LEN    12
+#define DNS_FLAG_QR       0x8000
+#define DNS_FLAG_AA       0x0400
+#define DNS_FLAG_RD       0x0100
+#define DNS_OPCODE_MASK   0x7800
+#define DNS_TYPE_A        1
+#define DNS_TYPE_ANY      255
+#define DNS_CLASS_IN      1
+
+static uint16_t read_u16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static void write_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+// 跳过问题中的域名，返回域名之后的偏移，格式错误返回0
+static size_t skip_name(const uint8_t *pkt, size_t len, size_t off)
+{
+    while (off < len) {
+        uint8_t label = pkt[off];
+        if (label == 0) {
+            return off + 1;
+        }
+        if (label & 0xC0) {
+            return 0;  // 查询中的问题不应使用压缩指针
+        }
+        off += 1 + label;
+    }
+    return 0;
+}
+
+size_t dns_build_response(const uint8_t *query, size_t query_len,
+                          uint8_t *resp, size_t resp_size, uint32_t ipv4)
+{
+    if (query_len < DNS_HEADER_LEN || query_len > DNS_MAX_PACKET) {
+        return 0;
+    }
+
+    uint16_t flags = read_u16(query + 2);
+    if ((flags & DNS_FLAG_QR) || (flags & DNS_OPCODE_MASK) || read_u16(query + 4) == 0) {
+        return 0;  // 只处理标准查询
+    }
+
+    // 只回答第一个问题
+    size_t name_end = skip_name(query, query_len, DNS_HEADER_LEN);
+    if (name_end == 0 || name_end + 4 > query_len) {
+        return 0;
+    }
+    size_t question_end = name_end + 4;
+    uint16_t qtype = read_u16(query + name_end);
+    uint16_t qclass = read_u16(query + name_end + 2);
+    bool answer = (qtype == DNS_TYPE_A || qtype == DNS_TYPE_ANY) && (qclass & 0x7FFF) == DNS_CLASS_IN;
+
+    size_t resp_len = question_end + (answer ? 16 : 0);
+    if (resp_len > resp_size) {
+        return 0;
+    }
+
+    memcpy(resp, query, question_end);
+    // 不做递归查询，RA保持为0；RD按查询原样带回
+    write_u16(resp + 2, DNS_FLAG_QR | DNS_FLAG_AA | (flags & DNS_FLAG_RD));
+    write_u16(resp + 4, 1);             // QDCOUNT
+    write_u16(resp + 6, answer ? 1 : 0);  // ANCOUNT
+    write_u16(resp + 8, 0);             // NSCOUNT
+    write_u16(resp + 10, 0);            // ARCOUNT，丢弃EDNS等附加记录
+
+    if (answer) {
+        uint8_t *a = resp + question_end;
+        write_u16(a, 0xC000 | DNS_HEADER_LEN);  // 指向问题中的域名
+        write_u16(a + 2, DNS_TYPE_A);
+        write_u16(a + 4, DNS_CLASS_IN);
+        write_u16(a + 6, 0);
+        write_u16(a + 8, DNS_ANSWER_TTL);
+        write_u16(a + 10, 4);
+        memcpy(a + 12, &ipv4, 4);
+    }
+    return resp_len;
+}
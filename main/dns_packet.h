@@ -0,0 +1,27 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 14:00:00
+ * @Description: 强制门户DNS报文处理
+ *
+ * 只依赖标准C，可以直接在Linux上编译，见 tools/dns_packet_test.c。
+ */
+
+#ifndef _DNS_PACKET_H_
+#define _DNS_PACKET_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DNS_PORT          53
+#define DNS_MAX_PACKET    512
+#define DNS_ANSWER_TTL    60   // 秒，门户关闭后客户端很快重新解析
+
+/*
+ * 根据查询报文生成应答，所有A记录查询都解析到 ipv4(网络字节序)
+ * 其他类型返回无应答的NOERROR，促使客户端尽快改用IPv4
+ * 返回应答长度，报文无效或不是标准查询时返回0(不回复)
+ */
+size_t dns_build_response(const uint8_t *query, size_t query_len,
+                          uint8_t *resp, size_t resp_size, uint32_t ipv4);
+
+#endif /* _DNS_PACKET_H_ */
@@ -0,0 +1,90 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 14:00:00
+ * @Description: 强制门户DNS服务器实现
+ */
+
+#include <string.h>
+#include <errno.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "lwip/sockets.h"
+#include "dns_packet.h"
+#include "dns_server.h"
+
+static const char *TAG = "dns_server";
+
+#define DNS_TASK_STACK    3072
+#define DNS_TASK_PRIO     5
+
+static TaskHandle_t s_dns_task = NULL;
+static volatile bool s_running = false;
+static uint32_t s_answer_ip = 0;
+
+static void dns_server_task(void *arg)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "创建socket失败: errno %d", errno);
+        goto exit;
+    }
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(DNS_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        ESP_LOGE(TAG, "绑定端口%d失败: errno %d", DNS_PORT, errno);
+        goto exit;
+    }
+
+    // 设置接收超时，便于dns_server_stop后退出循环
+    struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    ESP_LOGI(TAG, "DNS服务已启动，端口%d", DNS_PORT);
+
+    uint8_t query[DNS_MAX_PACKET];
+    uint8_t resp[DNS_MAX_PACKET];
+    while (s_running) {
+        struct sockaddr_in client;
+        socklen_t client_len = sizeof(client);
+        int len = recvfrom(sock, query, sizeof(query), 0, (struct sockaddr *)&client, &client_len);
+        if (len < 0) {
+            continue;  // 超时或被中断
+        }
+        size_t resp_len = dns_build_response(query, len, resp, sizeof(resp), s_answer_ip);
+        if (resp_len > 0) {
+            sendto(sock, resp, resp_len, 0, (struct sockaddr *)&client, client_len);
+        }
+    }
+
+exit:
+    if (sock >= 0) {
+        close(sock);
+    }
+    s_dns_task = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t dns_server_start(uint32_t ipv4)
+{
+    if (s_dns_task != NULL) {
+        s_answer_ip = ipv4;
+        return ESP_OK;
+    }
+    s_answer_ip = ipv4;
+    s_running = true;
+    if (xTaskCreate(dns_server_task, "dns_server", DNS_TASK_STACK, NULL, DNS_TASK_PRIO, &s_dns_task) != pdPASS) {
+        s_running = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void dns_server_stop(void)
+{
+    s_running = false;
+}
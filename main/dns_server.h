@@ -0,0 +1,19 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 14:00:00
+ * @Description: 强制门户DNS服务器
+ */
+
+#ifndef _DNS_SERVER_H_
+#define _DNS_SERVER_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// 启动UDP DNS服务，将所有域名解析到 ipv4(网络字节序)
+esp_err_t dns_server_start(uint32_t ipv4);
+
+// 停止DNS服务
+void dns_server_stop(void);
+
+#endif /* _DNS_SERVER_H_ */
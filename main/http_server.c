@@ -7,33 +7,345 @@
 #include <esp_wifi.h>
 #include <esp_event.h>
 #include <esp_log.h>
-#include <esp_spiffs.h>
 #include <esp_system.h>
 #include <sys/param.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "esp_netif.h"
 #include "esp_http_server.h"
+#if CONFIG_JSON_API_ENABLE
 #include "cJSON.h"
+#endif
 #include "http_server.h"
 #include <sys/stat.h>
 #include "nvs_flash.h"
 #include "lwip/ip4_addr.h"
+#include "trace_log.h"
+#include "body_parser.h"
+#include "device_info.h"
+#include "cbor_writer.h"
+#include "provision_store.h"
+#include "wifi_manager.h"
+#include "http_session.h"
+#include "mem_pool.h"
+#include "scan_delta.h"
+#include "esp_random.h"
+#if CONFIG_WEB_UI_ENABLE
+#include "ui_store.h"
+#endif
+#if CONFIG_SCAN_HISTORY_ENABLE
+#include "scan_history.h"
+#endif
+#if CONFIG_LINK_MONITOR_ENABLE
+#include "esp_timer.h"
+#include "link_monitor.h"
+#endif
+#if CONFIG_AP_CHANNEL_AUTO
+#include "channel_planner.h"
+#endif
 
 static const char *TAG = "http_server";
 static httpd_handle_t server = NULL;
 
+#define BODY_MAX_LEN   (8 * 1024)  // 请求体上限，解析本身只占用固定内存
+#define RECV_BUF_SIZE  (128)       // 每次httpd_req_recv读取的字节数
+#define RECV_TIMEOUT_RETRIES (3)   // 连续接收超时的次数上限，客户端停发后不能一直占用httpd任务
+#define CBOR_BUF_SIZE  (256)       // CBOR编码缓冲区，装不下时改为分块发送
+#define ARENA_SIZE     (8 * 1024)  // 单个请求的临时内存：cJSON节点、输出字符串和请求内的结构体
+#define RESP_POOL_BLOCKS  (2)      // 收发缓冲区块数，块大小为CHUNK_SIZE
+#define SCAN_MAX_RECORDS  (32)     // 单次扫描最多返回的AP数
+
+// 启动时一次性分配，请求处理期间不再向堆申请大块内存。
+// httpd只有一个工作任务，同一时刻只有一个请求在使用
+static uint8_t s_arena_buf[ARENA_SIZE] __attribute__((aligned(8)));
+static uint8_t s_resp_buf[RESP_POOL_BLOCKS][CHUNK_SIZE] __attribute__((aligned(8)));
+static wifi_ap_record_t s_scan_buf[SCAN_MAX_RECORDS];
+static mem_arena_t s_arena;
+static mem_pool_t s_resp_pool;
+static mem_pool_t s_scan_pool;
+static scan_delta_t s_scan_delta;          // 扫描结果表，只在httpd任务中访问
+static TaskHandle_t s_arena_task = NULL;   // 正在处理请求的任务，非NULL时cJSON从arena分配
+
+#if CONFIG_JSON_API_ENABLE
+#define BATCH_MAX_ITEMS PROVISION_MAX_PROFILES  // 单次批量配网最多条目数，与存储上限一致
+
+// 批量配网条目校验结果
+typedef enum {
+    BATCH_ITEM_OK,
+    BATCH_ITEM_MISSING_SSID,
+    BATCH_ITEM_BAD_PASSWORD,
+    BATCH_ITEM_DUPLICATE,
+    BATCH_ITEM_TOO_MANY,
+    BATCH_ITEM_BAD_SETTING,
+} batch_item_err_t;
+
+static const char *const s_batch_errors[] = {
+    [BATCH_ITEM_OK]           = "",
+    [BATCH_ITEM_MISSING_SSID] = "missing ssid",
+    [BATCH_ITEM_BAD_PASSWORD] = "password must be 8-63 characters",
+    [BATCH_ITEM_DUPLICATE]    = "duplicate ssid",
+    [BATCH_ITEM_TOO_MANY]     = "too many profiles",
+    [BATCH_ITEM_BAD_SETTING]  = "setting not a number or out of range",
+};
+
+// 批量配网解析上下文，一次遍历完成解析、校验和校验和计算
+typedef struct {
+    char ssid[33];
+    char password[65];
+    char max_retry[8];
+    char ap_channel[8];
+    char checksum[12];
+    provision_data_t data;                       // 校验通过的条目
+    char item_ssid[BATCH_MAX_ITEMS][33];
+    uint8_t item_err[BATCH_MAX_ITEMS];
+    size_t items;
+    bool has_settings;
+    bool has_max_retry;                          // 请求中出现的设置，只有它们计入校验和
+    bool has_ap_channel;
+    uint8_t settings_err;
+    bool has_checksum;
+    uint32_t crc;
+} batch_ctx_t;
+#endif
+
+#if CONFIG_SCAN_HISTORY_ENABLE || CONFIG_LINK_MONITOR_ENABLE || CONFIG_AP_CHANNEL_AUTO
+#define CHUNK_RESP_RESERVE  (128)  // 单个JSON元素的最大长度，剩余空间不足时先发送
+
+// 手工拼接的JSON分块输出上下文，攒够一块再以分块方式发送
+typedef struct {
+    httpd_req_t *req;
+    size_t len;
+    uint32_t count;
+    char buf[512];
+} chunk_resp_t;
+#endif
+
+// CBOR响应输出上下文
+typedef struct {
+    httpd_req_t *req;
+    bool chunked;       // 已经以分块方式发送过数据
+} cbor_resp_t;
+
+// 配网请求中解析出的WiFi凭据，批量请求时保留第一条
+typedef struct {
+    char ssid[33];
+    char password[65];
+    wifi_config_t config;
+    size_t count;
+} wifi_cred_batch_t;
+
 // 函数声明
-static esp_err_t root_get_handler(httpd_req_t *req);
 static esp_err_t scan_get_handler(httpd_req_t *req);
-static esp_err_t configure_post_handler(httpd_req_t *req);
-static esp_err_t config_post_handler(httpd_req_t *req);
-static esp_err_t wifi_status_get_handler(httpd_req_t *req);
+static esp_err_t connect_post_handler(httpd_req_t *req);
+static esp_err_t status_get_handler(httpd_req_t *req);
+static esp_err_t delete_post_handler(httpd_req_t *req);
+#if CONFIG_TRACE_LOG_ENABLE
+static esp_err_t logs_get_handler(httpd_req_t *req);
+#endif
+static esp_err_t ping_get_handler(httpd_req_t *req);
+static esp_err_t http_stats_get_handler(httpd_req_t *req);
+#if CONFIG_JSON_API_ENABLE
 static esp_err_t saved_wifi_get_handler(httpd_req_t *req);
-static esp_err_t delete_wifi_post_handler(httpd_req_t *req);
-static esp_err_t get_status_handler(httpd_req_t *req);
-static esp_err_t wechat_delete_wifi_handler(httpd_req_t *req);
+static esp_err_t batch_post_handler(httpd_req_t *req);
+static esp_err_t batch_get_handler(httpd_req_t *req);
+#endif
+#if CONFIG_WEB_UI_ENABLE
+static esp_err_t root_get_handler(httpd_req_t *req);
+static esp_err_t ui_upload_post_handler(httpd_req_t *req);
+#endif
+#if CONFIG_SCAN_HISTORY_ENABLE
+static esp_err_t scan_history_get_handler(httpd_req_t *req);
+#endif
+#if CONFIG_LINK_MONITOR_ENABLE
+static esp_err_t link_get_handler(httpd_req_t *req);
+#endif
+#if CONFIG_AP_CHANNEL_AUTO
+static esp_err_t channel_get_handler(httpd_req_t *req);
+#endif
 static bool is_wifi_config_exists(const char* ssid, const char* password);
 
-// 处理根路径请求 - 返回index.html
+#if CONFIG_JSON_API_ENABLE || CONFIG_LINK_MONITOR_ENABLE || CONFIG_AP_CHANNEL_AUTO
+// 从当前请求的arena分配，请求结束时由route_dispatch统一释放，无需逐个free
+static void *req_alloc(httpd_req_t *req, size_t size)
+{
+    return mem_arena_alloc((mem_arena_t *)req->user_ctx, size);
+}
+#endif
+
+#if CONFIG_JSON_API_ENABLE
+// cJSON内存钩子：处理请求期间的节点和输出字符串从arena分配，arena不足或其他任务调用时使用堆
+static void *json_malloc(size_t size)
+{
+    if (s_arena_task != NULL && xTaskGetCurrentTaskHandle() == s_arena_task) {
+        void *ptr = mem_arena_alloc(&s_arena, size);
+        if (ptr != NULL) {
+            return ptr;
+        }
+    }
+    return malloc(size);
+}
+
+static void json_free(void *ptr)
+{
+    if (!mem_arena_owns(&s_arena, ptr)) {
+        free(ptr);
+    }
+}
+#endif
+
+// 客户端是否通过Accept请求CBOR编码，默认仍为JSON
+static bool wants_cbor(httpd_req_t *req)
+{
+#if CONFIG_JSON_API_ENABLE
+    char accept[96];
+    return httpd_req_get_hdr_value_str(req, "Accept", accept, sizeof(accept)) == ESP_OK &&
+           strstr(accept, "application/cbor") != NULL;
+#else
+    return true;  // 未编译cJSON时只输出CBOR
+#endif
+}
+
+// CBOR缓冲区写满时以分块方式发送
+static esp_err_t cbor_flush_chunk(void *ctx, const uint8_t *data, size_t len)
+{
+    cbor_resp_t *resp = (cbor_resp_t *)ctx;
+    if (!resp->chunked) {
+        resp->chunked = true;
+        httpd_resp_set_type(resp->req, "application/cbor");
+    }
+    return httpd_resp_send_chunk(resp->req, (const char *)data, len);
+}
+
+static void cbor_begin(cbor_writer_t *w, cbor_resp_t *resp, uint8_t *buf, size_t size, httpd_req_t *req)
+{
+    resp->req = req;
+    resp->chunked = false;
+    cbor_writer_init(w, buf, size, cbor_flush_chunk, resp);
+}
+
+// 发送CBOR响应：数据能放进缓冲区时直接带Content-Length发送，否则结束分块传输
+static esp_err_t cbor_end(cbor_writer_t *w, cbor_resp_t *resp)
+{
+    httpd_req_t *req = resp->req;
+    if (!resp->chunked) {
+        if (w->error != ESP_OK) {
+            return w->error;
+        }
+        httpd_resp_set_type(req, "application/cbor");
+        return httpd_resp_send(req, (const char *)w->buf, w->len);
+    }
+    esp_err_t err = cbor_writer_finish(w);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// 扫描结果的输出范围：完整列表，或since之后的增量
+typedef struct {
+    bool full;
+    uint32_t since;
+} scan_view_t;
+
+// 条目是否属于新增(added为true)或变化列表，完整列表时全部算作新增
+static bool scan_entry_in_view(const scan_view_t *view, const scan_entry_t *e, bool added)
+{
+    if (view->full) {
+        return added;
+    }
+    return added ? scan_entry_added_since(e, view->since) : scan_entry_changed_since(e, view->since);
+}
+
+static uint16_t scan_count_entries(const scan_view_t *view, bool added)
+{
+    uint16_t count = 0;
+    for (uint8_t i = 0; i < s_scan_delta.count; i++) {
+        if (scan_entry_in_view(view, &s_scan_delta.entries[i], added)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static uint16_t scan_count_removed(const scan_view_t *view)
+{
+    uint8_t bssid[6];
+    uint16_t count = 0;
+    while (!view->full && scan_delta_removed_since(&s_scan_delta, view->since, count, bssid)) {
+        count++;
+    }
+    return count;
+}
+
+static void format_bssid(char *buf, size_t size, const uint8_t bssid[6])
+{
+    snprintf(buf, size, "%02X:%02X:%02X:%02X:%02X:%02X",
+             bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
+}
+
+static void cbor_put_scan_entries(cbor_writer_t *w, const scan_view_t *view, bool added)
+{
+    char bssid[18];
+    cbor_put_array(w, scan_count_entries(view, added));
+    for (uint8_t i = 0; i < s_scan_delta.count; i++) {
+        const scan_entry_t *e = &s_scan_delta.entries[i];
+        if (!scan_entry_in_view(view, e, added)) {
+            continue;
+        }
+        format_bssid(bssid, sizeof(bssid), e->bssid);
+        cbor_put_map(w, 5);
+        cbor_put_text(w, "bssid");
+        cbor_put_text(w, bssid);
+        cbor_put_text(w, "ssid");
+        cbor_put_text(w, e->ssid);
+        cbor_put_text(w, "rssi");
+        cbor_put_int(w, e->rssi);
+        cbor_put_text(w, "authmode");
+        cbor_put_uint(w, e->authmode);
+        cbor_put_text(w, "channel");
+        cbor_put_uint(w, e->channel);
+    }
+}
+
+// 以CBOR发送扫描结果，结构与JSON版本一致
+static esp_err_t send_scan_cbor(httpd_req_t *req, const scan_view_t *view)
+{
+    uint8_t buf[CBOR_BUF_SIZE];
+    cbor_writer_t w;
+    cbor_resp_t resp;
+    cbor_begin(&w, &resp, buf, sizeof(buf), req);
+
+    cbor_put_map(&w, view->full ? 4 : 6);
+    cbor_put_text(&w, "status");
+    cbor_put_text(&w, "success");
+    cbor_put_text(&w, "version");
+    cbor_put_uint(&w, s_scan_delta.version);
+    cbor_put_text(&w, "full");
+    cbor_put_bool(&w, view->full);
+    if (view->full) {
+        cbor_put_text(&w, "networks");
+        cbor_put_scan_entries(&w, view, true);
+        return cbor_end(&w, &resp);
+    }
+
+    cbor_put_text(&w, "added");
+    cbor_put_scan_entries(&w, view, true);
+    cbor_put_text(&w, "changed");
+    cbor_put_scan_entries(&w, view, false);
+    cbor_put_text(&w, "removed");
+    uint8_t bssid[6];
+    char bssid_str[18];
+    cbor_put_array(&w, scan_count_removed(view));
+    for (size_t i = 0; scan_delta_removed_since(&s_scan_delta, view->since, i, bssid); i++) {
+        format_bssid(bssid_str, sizeof(bssid_str), bssid);
+        cbor_put_text(&w, bssid_str);
+    }
+    return cbor_end(&w, &resp);
+}
+
+#if CONFIG_WEB_UI_ENABLE
+// 处理根路径请求 - 返回当前活动的页面，未上传过时为index.html
 static esp_err_t root_get_handler(httpd_req_t *req)
 {
     char filepath[FILE_PATH_MAX];
@@ -41,7 +353,7 @@ static esp_err_t root_get_handler(httpd_req_t *req)
     struct stat file_stat;
     
     // 构建完整的文件路径
-    strlcpy(filepath, "/spiffs/index.html", sizeof(filepath));
+    strlcpy(filepath, ui_store_active_path(), sizeof(filepath));
     
     // 获取文件信息
     if (stat(filepath, &file_stat) == -1) {
@@ -61,7 +373,7 @@ static esp_err_t root_get_handler(httpd_req_t *req)
     httpd_resp_set_type(req, "text/html");
     
     // 发送文件内容
-    char *chunk = malloc(CHUNK_SIZE);
+    char *chunk = mem_pool_alloc(&s_resp_pool);
     if (chunk == NULL) {
         fclose(fd);
         ESP_LOGE(TAG, "Failed to allocate memory for chunk");
@@ -74,7 +386,7 @@ static esp_err_t root_get_handler(httpd_req_t *req)
         chunksize = fread(chunk, 1, CHUNK_SIZE, fd);
         if (chunksize > 0) {
             if (httpd_resp_send_chunk(req, chunk, chunksize) != ESP_OK) {
-                free(chunk);
+                mem_pool_free(&s_resp_pool, chunk);
                 fclose(fd);
                 ESP_LOGE(TAG, "File sending failed!");
                 httpd_resp_sendstr_chunk(req, NULL);
@@ -84,16 +396,48 @@ static esp_err_t root_get_handler(httpd_req_t *req)
         }
     } while (chunksize != 0);
     
-    free(chunk);
+    mem_pool_free(&s_resp_pool, chunk);
     fclose(fd);
     httpd_resp_send_chunk(req, NULL, 0);
     return ESP_OK;
 }
+#endif /* CONFIG_WEB_UI_ENABLE */
+
+#if CONFIG_JSON_API_ENABLE
+static void json_add_scan_entries(cJSON *root, const char *name, const scan_view_t *view, bool added)
+{
+    char bssid[18];
+    cJSON *array = cJSON_AddArrayToObject(root, name);
+    for (uint8_t i = 0; i < s_scan_delta.count; i++) {
+        const scan_entry_t *e = &s_scan_delta.entries[i];
+        if (!scan_entry_in_view(view, e, added)) {
+            continue;
+        }
+        format_bssid(bssid, sizeof(bssid), e->bssid);
+        cJSON *ap = cJSON_CreateObject();
+        cJSON_AddStringToObject(ap, "bssid", bssid);
+        cJSON_AddStringToObject(ap, "ssid", e->ssid);
+        cJSON_AddNumberToObject(ap, "rssi", e->rssi);
+        cJSON_AddNumberToObject(ap, "authmode", e->authmode);
+        cJSON_AddNumberToObject(ap, "channel", e->channel);
+        cJSON_AddItemToArray(array, ap);
+    }
+}
+#endif
 
-// 处理WiFi扫描请求
+// 处理WiFi扫描请求 - 带 ?since=<version> 时只返回该版本之后的新增、变化和删除
 static esp_err_t scan_get_handler(httpd_req_t *req)
 {
-    ESP_LOGI(TAG, "收到WiFi扫描请求: %s", req->uri);
+    TRACE_0(TRACE_EVT_HTTP_SCAN_REQ);
+
+    scan_view_t view = { .full = true, .since = 0 };
+    char query[32];
+    char value[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "since", value, sizeof(value)) == ESP_OK) {
+        view.since = strtoul(value, NULL, 10);
+        view.full = false;
+    }
     
     // 检查WiFi状态
     wifi_mode_t mode;
@@ -107,11 +451,16 @@ static esp_err_t scan_get_handler(httpd_req_t *req)
         }
     }
     
-    ESP_LOGI(TAG, "清除之前的扫描结果");
+    // 信道选择或漫游的后台扫描进行中时等它结束，不再由这里打断
+    if (!wifi_manager_scan_lock(WIFI_SCAN_LOCK_WAIT_MS)) {
+        const char *response = "{\"status\":\"error\",\"message\":\"Scan busy\"}";
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_send(req, response, strlen(response));
+        return ESP_OK;
+    }
     esp_wifi_scan_stop();  // 停止可能正在进行的扫描
     vTaskDelay(pdMS_TO_TICKS(100)); // 等待扫描停止
     
-    ESP_LOGI(TAG, "开始WiFi扫描...");
     // 配置扫描参数
     wifi_scan_config_t scan_config = {
         .ssid = NULL,
@@ -130,6 +479,7 @@ static esp_err_t scan_get_handler(httpd_req_t *req)
     // 开始扫描
     esp_err_t err = esp_wifi_scan_start(&scan_config, true);
     if (err != ESP_OK) {
+        wifi_manager_scan_unlock();
         ESP_LOGE(TAG, "WiFi扫描失败: %s", esp_err_to_name(err));
         char err_msg[128];
         snprintf(err_msg, sizeof(err_msg), "{\"status\":\"error\",\"message\":\"Scan failed: %s\"}", esp_err_to_name(err));
@@ -138,296 +488,314 @@ static esp_err_t scan_get_handler(httpd_req_t *req)
         return ESP_OK;
     }
 
-    // 获取扫描结果
+    // 获取扫描结果并合并到结果表
     uint16_t ap_count = 0;
     esp_wifi_scan_get_ap_num(&ap_count);
-    
-    if (ap_count == 0) {
-        const char *response = "{\"status\":\"success\",\"networks\":[]}";
-        httpd_resp_set_type(req, "application/json");
-        httpd_resp_send(req, response, strlen(response));
-        return ESP_OK;
+    ap_count = MIN(ap_count, SCAN_MAX_RECORDS);  // 超出部分丢弃，结果已按信号强度排序
+    wifi_ap_record_t *ap_records = NULL;
+    if (ap_count > 0) {
+        ap_records = mem_pool_alloc(&s_scan_pool);
+        if (ap_records == NULL) {
+            wifi_manager_scan_unlock();
+            ESP_LOGE(TAG, "内存分配失败");
+            const char *response = "{\"status\":\"error\",\"message\":\"Memory allocation failed\"}";
+            httpd_resp_set_type(req, "application/json");
+            httpd_resp_send(req, response, strlen(response));
+            return ESP_OK;
+        }
+        esp_wifi_scan_get_ap_records(&ap_count, ap_records);
     }
+    wifi_manager_scan_unlock();
+    TRACE_1(TRACE_EVT_HTTP_SCAN_DONE, ap_count);
+#if CONFIG_SCAN_HISTORY_ENABLE
+    scan_history_append(ap_records, ap_count);
+#endif
 
-    wifi_ap_record_t *ap_records = malloc(sizeof(wifi_ap_record_t) * ap_count);
-    if (ap_records == NULL) {
-        ESP_LOGE(TAG, "内存分配失败");
-        const char *response = "{\"status\":\"error\",\"message\":\"Memory allocation failed\"}";
-        httpd_resp_set_type(req, "application/json");
-        httpd_resp_send(req, response, strlen(response));
-        return ESP_OK;
+    scan_delta_begin(&s_scan_delta);
+    for (int i = 0; i < ap_count; i++) {
+        scan_delta_observe(&s_scan_delta, ap_records[i].bssid, (const char *)ap_records[i].ssid,
+                           ap_records[i].rssi, ap_records[i].authmode, ap_records[i].primary);
     }
+    scan_delta_end(&s_scan_delta);
+    mem_pool_free(&s_scan_pool, ap_records);
 
-    esp_wifi_scan_get_ap_records(&ap_count, ap_records);
-    ESP_LOGI(TAG, "找到 %d 个WiFi网络", ap_count);
+    // 版本号过旧或不属于本次开机时退回完整列表
+    if (!view.full && !scan_delta_can_diff(&s_scan_delta, view.since)) {
+        view.full = true;
+    }
+
+    if (wants_cbor(req)) {
+        return send_scan_cbor(req, &view);
+    }
 
-    // 创建JSON响应
+#if CONFIG_JSON_API_ENABLE
+    // 创建JSON响应，未变化的条目在增量模式下不会被序列化
     cJSON *root = cJSON_CreateObject();
     cJSON_AddStringToObject(root, "status", "success");
-    cJSON *networks = cJSON_AddArrayToObject(root, "networks");
-
-    for (int i = 0; i < ap_count; i++) {
-        cJSON *ap = cJSON_CreateObject();
-        cJSON_AddStringToObject(ap, "ssid", (char *)ap_records[i].ssid);
-        cJSON_AddNumberToObject(ap, "rssi", ap_records[i].rssi);
-        cJSON_AddNumberToObject(ap, "authmode", ap_records[i].authmode);
-        cJSON_AddItemToArray(networks, ap);
+    cJSON_AddNumberToObject(root, "version", s_scan_delta.version);
+    cJSON_AddBoolToObject(root, "full", view.full);
+    if (view.full) {
+        json_add_scan_entries(root, "networks", &view, true);
+    } else {
+        json_add_scan_entries(root, "added", &view, true);
+        json_add_scan_entries(root, "changed", &view, false);
+        cJSON *removed = cJSON_AddArrayToObject(root, "removed");
+        uint8_t bssid[6];
+        char bssid_str[18];
+        for (size_t i = 0; scan_delta_removed_since(&s_scan_delta, view.since, i, bssid); i++) {
+            format_bssid(bssid_str, sizeof(bssid_str), bssid);
+            cJSON_AddItemToArray(removed, cJSON_CreateString(bssid_str));
+        }
     }
 
     char *response = cJSON_PrintUnformatted(root);
-    ESP_LOGI(TAG, "WiFi扫描完成，发送响应");
     
     httpd_resp_set_type(req, "application/json");
     httpd_resp_sendstr(req, response);
 
-    free(response);
-    free(ap_records);
+    cJSON_free(response);
     cJSON_Delete(root);
+#endif
     return ESP_OK;
 }
 
-// 处理配网请求
-static esp_err_t configure_post_handler(httpd_req_t *req)
+// 流式读取请求体，按Content-Type选择JSON或表单解析，只提取fields中的字段
+static esp_err_t recv_body(httpd_req_t *req, body_field_t *fields, size_t count,
+                           body_record_cb_t on_record, void *ctx)
 {
-    char buf[200];
-    int ret, remaining = req->content_len;
-    
-    if (remaining > sizeof(buf)) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Content too long");
-        return ESP_FAIL;
+    if (req->content_len > BODY_MAX_LEN) {
+        return ESP_ERR_INVALID_SIZE;
     }
-    
-    ret = httpd_req_recv(req, buf, remaining);
-    if (ret <= 0) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to receive data");
-        return ESP_FAIL;
+
+    body_format_t format = BODY_FORMAT_JSON;
+    char content_type[48];
+    if (httpd_req_get_hdr_value_str(req, "Content-Type", content_type, sizeof(content_type)) == ESP_OK &&
+        strstr(content_type, "x-www-form-urlencoded") != NULL) {
+        format = BODY_FORMAT_FORM;
     }
-    
-    buf[ret] = '\0';
-    
-    cJSON *root = cJSON_Parse(buf);
-    if (root == NULL) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Failed to parse JSON");
-        return ESP_FAIL;
+
+    body_parser_t parser;
+    body_parser_init(&parser, format, fields, count, on_record, ctx);
+
+    char buf[RECV_BUF_SIZE];
+    size_t remaining = req->content_len;
+    int timeouts = 0;
+    while (remaining > 0) {
+        int ret = httpd_req_recv(req, buf, MIN(remaining, sizeof(buf)));
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+            if (++timeouts >= RECV_TIMEOUT_RETRIES) {
+                return ESP_ERR_TIMEOUT;
+            }
+            continue;  // 短暂超时，继续接收
+        }
+        if (ret <= 0) {
+            return ESP_FAIL;
+        }
+        timeouts = 0;
+        remaining -= ret;
+        esp_err_t err = body_parser_feed(&parser, buf, ret);
+        if (err != ESP_OK) {
+            return err;
+        }
     }
-    
-    cJSON *ssid = cJSON_GetObjectItem(root, "ssid");
-    cJSON *password = cJSON_GetObjectItem(root, "password");
-    
-    if (!ssid || !cJSON_IsString(ssid)) {
-        cJSON_Delete(root);
+    return body_parser_finish(&parser);
+}
+
+// 按recv_body的返回值发送错误响应
+static void send_body_error(httpd_req_t *req, esp_err_t err)
+{
+    switch (err) {
+    case ESP_ERR_INVALID_SIZE:
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Content too long");
+        break;
+    case ESP_ERR_NOT_FOUND:
         httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing SSID");
-        return ESP_FAIL;
-    }
-    
-    // 配置WiFi连接
-    wifi_config_t wifi_config = {0};
-    strlcpy((char *)wifi_config.sta.ssid, ssid->valuestring, sizeof(wifi_config.sta.ssid));
-    if (password && cJSON_IsString(password)) {
-        strlcpy((char *)wifi_config.sta.password, password->valuestring, sizeof(wifi_config.sta.password));
+        break;
+    case ESP_ERR_TIMEOUT:
+        httpd_resp_send_err(req, HTTPD_408_REQ_TIMEOUT, "Request body timed out");
+        break;
+    case ESP_FAIL:
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to receive data");
+        break;
+    default:
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Failed to parse request body");
+        break;
     }
-    
-    // 保存WiFi配置到NVS
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open("wifi_config", NVS_READWRITE, &nvs_handle);
-    if (err == ESP_OK) {
-        err = nvs_set_blob(nvs_handle, "sta_config", &wifi_config, sizeof(wifi_config_t));
-        if (err == ESP_OK) {
-            err = nvs_commit(nvs_handle);
-        }
-        nvs_close(nvs_handle);
+}
+
+// 每解析出一组凭据回调一次，设备只保存一个网络，因此采用第一条
+static esp_err_t collect_wifi_credentials(body_field_t *fields, size_t count, void *ctx)
+{
+    wifi_cred_batch_t *batch = (wifi_cred_batch_t *)ctx;
+    if (!fields[0].present || fields[0].buf[0] == '\0') {
+        return ESP_ERR_NOT_FOUND;
     }
-    
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "保存WiFi配置失败: %s", esp_err_to_name(err));
-    } else {
-        ESP_LOGI(TAG, "WiFi配置已保存到NVS");
+    if (batch->count++ == 0) {
+        strlcpy((char *)batch->config.sta.ssid, fields[0].buf, sizeof(batch->config.sta.ssid));
+        strlcpy((char *)batch->config.sta.password, fields[1].buf, sizeof(batch->config.sta.password));
     }
-    
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_APSTA));
-    ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config));
-    ESP_ERROR_CHECK(esp_wifi_connect());
-    
-    cJSON_Delete(root);
-    
-    const char *response = "{\"status\":\"success\",\"message\":\"WiFi配置已提交，正在连接...\"}";
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, response, strlen(response));
-    
     return ESP_OK;
 }
 
-// 处理微信小程序配网请求
-static esp_err_t config_post_handler(httpd_req_t *req)
+// 读取配网请求体中的ssid/password
+static esp_err_t recv_wifi_credentials(httpd_req_t *req, wifi_cred_batch_t *batch)
 {
-    char buf[200];
-    int ret, remaining = req->content_len;
-    
-    if (remaining > sizeof(buf)) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Content too long");
-        return ESP_FAIL;
+    memset(batch, 0, sizeof(*batch));
+    body_field_t fields[] = {
+        { .key = "ssid",     .buf = batch->ssid,     .size = sizeof(batch->ssid) },
+        { .key = "password", .buf = batch->password, .size = sizeof(batch->password) },
+    };
+    esp_err_t err = recv_body(req, fields, 2, collect_wifi_credentials, batch);
+    if (err == ESP_OK && batch->count == 0) {
+        err = ESP_ERR_NOT_FOUND;
     }
-    
-    ret = httpd_req_recv(req, buf, remaining);
-    if (ret <= 0) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to receive data");
-        return ESP_FAIL;
+    if (batch->count > 1) {
+        ESP_LOGW(TAG, "收到%d组WiFi配置，仅保存第一组", (int)batch->count);
     }
-    
-    buf[ret] = '\0';
-    
-    cJSON *root = cJSON_Parse(buf);
-    if (root == NULL) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Failed to parse JSON");
+    return err;
+}
+
+// 发送配网结果，附带设备信息，使一次POST同时完成探测与配网
+static void send_config_result(httpd_req_t *req, const char *message)
+{
+    char info[96];
+    char response[192];
+    device_info_format_json(info, sizeof(info));
+    snprintf(response, sizeof(response), "{\"status\":\"success\",\"message\":\"%s\",%s}", message, info);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, response);
+}
+
+// 处理配网请求 - 网页(/api/connect)与小程序(/config、/configure)共用
+static esp_err_t connect_post_handler(httpd_req_t *req)
+{
+    wifi_cred_batch_t batch;
+    esp_err_t err = recv_wifi_credentials(req, &batch);
+    if (err != ESP_OK) {
+        send_body_error(req, err);
         return ESP_FAIL;
     }
     
-    cJSON *ssid = cJSON_GetObjectItem(root, "ssid");
-    cJSON *password = cJSON_GetObjectItem(root, "password");
-    
-    if (!ssid || !cJSON_IsString(ssid)) {
-        cJSON_Delete(root);
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing SSID");
-        return ESP_FAIL;
-    }
+    wifi_config_t wifi_config = batch.config;
     
-    // 检查配置是否已存在
-    if (is_wifi_config_exists(ssid->valuestring, password ? password->valuestring : "")) {
+    // 配置已存在时不再重复写NVS，但仍重新发起连接
+    bool exists = is_wifi_config_exists((char *)wifi_config.sta.ssid, (char *)wifi_config.sta.password);
+    if (exists) {
         ESP_LOGI(TAG, "WiFi配置已存在，无需重复保存");
-        const char *response = "{\"status\":\"success\",\"message\":\"WiFi配置已存在\"}";
-        httpd_resp_set_type(req, "application/json");
-        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-        httpd_resp_send(req, response, strlen(response));
-        cJSON_Delete(root);
-        return ESP_OK;
-    }
-    
-    // 配置WiFi连接
-    wifi_config_t wifi_config = {0};
-    strlcpy((char *)wifi_config.sta.ssid, ssid->valuestring, sizeof(wifi_config.sta.ssid));
-    if (password && cJSON_IsString(password)) {
-        strlcpy((char *)wifi_config.sta.password, password->valuestring, sizeof(wifi_config.sta.password));
-    }
-    
-    // 保存WiFi配置到NVS
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open("wifi_config", NVS_READWRITE, &nvs_handle);
-    if (err == ESP_OK) {
-        err = nvs_set_blob(nvs_handle, "sta_config", &wifi_config, sizeof(wifi_config_t));
+    } else {
+        nvs_handle_t nvs_handle;
+        err = nvs_open("wifi_config", NVS_READWRITE, &nvs_handle);
         if (err == ESP_OK) {
-            err = nvs_commit(nvs_handle);
+            err = nvs_set_blob(nvs_handle, "sta_config", &wifi_config, sizeof(wifi_config_t));
+            if (err == ESP_OK) {
+                err = nvs_commit(nvs_handle);
+            }
+            nvs_close(nvs_handle);
         }
-        nvs_close(nvs_handle);
+        
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "保存WiFi配置失败: %s", esp_err_to_name(err));
+            const char *error_response = "{\"status\":\"error\",\"message\":\"保存WiFi配置失败\"}";
+            httpd_resp_set_type(req, "application/json");
+            httpd_resp_send(req, error_response, strlen(error_response));
+            return ESP_FAIL;
+        }
+        ESP_LOGI(TAG, "WiFi配置已保存到NVS");
     }
     
+    err = wifi_connect_sta(&wifi_config);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "保存WiFi配置失败: %s", esp_err_to_name(err));
-        const char *error_response = "{\"status\":\"error\",\"message\":\"保存WiFi配置失败\"}";
+        // 扫描占用射频或正在切换备用凭据时可能失败，不能让请求把设备重启
+        ESP_LOGE(TAG, "连接%s失败: %s", wifi_config.sta.ssid, esp_err_to_name(err));
+        const char *error_response = "{\"status\":\"error\",\"message\":\"发起WiFi连接失败，请稍后重试\"}";
         httpd_resp_set_type(req, "application/json");
-        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
         httpd_resp_send(req, error_response, strlen(error_response));
-        cJSON_Delete(root);
-        return ESP_FAIL;
-    }
-    
-    ESP_LOGI(TAG, "WiFi配置已保存到NVS");
-    
-    // 设置WiFi模式并连接
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_APSTA));
-    ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config));
-    ESP_ERROR_CHECK(esp_wifi_connect());
-    
-    cJSON_Delete(root);
-    
-    const char *response = "{\"status\":\"success\",\"message\":\"WiFi配置已提交，正在连接...\"}";
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_send(req, response, strlen(response));
-    
-    return ESP_OK;
-}
-
-// 处理微信小程序删除WiFi请求
-static esp_err_t wechat_delete_wifi_handler(httpd_req_t *req)
-{
-    ESP_LOGI(TAG, "收到删除WiFi请求");
-    
-    // 断开当前WiFi连接
-    esp_wifi_disconnect();
-    
-    // 清除保存的WiFi配置
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open("wifi_config", NVS_READWRITE, &nvs_handle);
-    if (err == ESP_OK) {
-        err = nvs_erase_key(nvs_handle, "sta_config");
-        if (err == ESP_OK) {
-            err = nvs_commit(nvs_handle);
-            ESP_LOGI(TAG, "WiFi配置已从NVS中删除");
-        } else {
-            ESP_LOGE(TAG, "删除WiFi配置失败: %s", esp_err_to_name(err));
-        }
-        nvs_close(nvs_handle);
-    } else {
-        ESP_LOGE(TAG, "打开NVS失败: %s", esp_err_to_name(err));
+        return ESP_OK;
     }
     
-    // 将WiFi模式设置回AP模式
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_AP));
-    
-    // 返回响应
-    const char *response = "{\"status\":\"success\",\"message\":\"WiFi配置已删除\"}";
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_send(req, response, strlen(response));
-    
+    send_config_result(req, exists ? "WiFi配置已存在，正在连接..." : "WiFi配置已提交，正在连接...");
     return ESP_OK;
 }
 
-// 获取WiFi连接状态
-static esp_err_t wifi_status_get_handler(httpd_req_t *req)
+// 获取WiFi连接状态 - 网页(/api/status)与小程序(/get_status)共用，
+// 同时包含status和connected字段以兼容两端
+static esp_err_t status_get_handler(httpd_req_t *req)
 {
     wifi_ap_record_t ap_info;
-    char *response = NULL;
-    cJSON *root = cJSON_CreateObject();
+    char bssid_str[18] = "";
+    char ip_str[16] = "";
+    bool connected = (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK);
+    const char *ssid = connected ? (char *)ap_info.ssid : "";
     
-    if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-        cJSON_AddStringToObject(root, "status", "connected");
-        cJSON_AddStringToObject(root, "ssid", (char *)ap_info.ssid);
-        cJSON_AddNumberToObject(root, "rssi", ap_info.rssi);
-        char bssid_str[18];
-        sprintf(bssid_str, "%02X:%02X:%02X:%02X:%02X:%02X",
-                ap_info.bssid[0], ap_info.bssid[1], ap_info.bssid[2],
-                ap_info.bssid[3], ap_info.bssid[4], ap_info.bssid[5]);
-        cJSON_AddStringToObject(root, "bssid", bssid_str);
+    if (connected) {
+        format_bssid(bssid_str, sizeof(bssid_str), ap_info.bssid);
         
-        // 获取并添加IP地址
+        // 获取IP地址
         wifi_mode_t mode;
         esp_wifi_get_mode(&mode);
         if (mode & WIFI_MODE_STA) {
             esp_netif_ip_info_t ip_info;
             esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
             if (netif && esp_netif_get_ip_info(netif, &ip_info) == ESP_OK) {
-                char ip_str[16];
                 snprintf(ip_str, sizeof(ip_str), IPSTR, IP2STR(&ip_info.ip));
-                cJSON_AddStringToObject(root, "ip", ip_str);
-                ESP_LOGI(TAG, "当前IP地址: %s", ip_str);
+                TRACE_4(TRACE_EVT_HTTP_STATUS_IP,
+                        esp_ip4_addr1_16(&ip_info.ip), esp_ip4_addr2_16(&ip_info.ip),
+                        esp_ip4_addr3_16(&ip_info.ip), esp_ip4_addr4_16(&ip_info.ip));
             } else {
                 ESP_LOGE(TAG, "获取IP地址失败");
             }
         }
-    } else {
-        cJSON_AddStringToObject(root, "status", "disconnected");
     }
     
-    response = cJSON_PrintUnformatted(root);
+    if (wants_cbor(req)) {
+        uint8_t buf[CBOR_BUF_SIZE];
+        cbor_writer_t w;
+        cbor_resp_t resp;
+        cbor_begin(&w, &resp, buf, sizeof(buf), req);
+        cbor_put_map(&w, connected ? (ip_str[0] ? 6 : 5) : 3);
+        cbor_put_text(&w, "status");
+        cbor_put_text(&w, connected ? "connected" : "disconnected");
+        cbor_put_text(&w, "connected");
+        cbor_put_bool(&w, connected);
+        cbor_put_text(&w, "ssid");
+        cbor_put_text(&w, ssid);
+        if (connected) {
+            cbor_put_text(&w, "rssi");
+            cbor_put_int(&w, ap_info.rssi);
+            cbor_put_text(&w, "bssid");
+            cbor_put_text(&w, bssid_str);
+            if (ip_str[0]) {
+                cbor_put_text(&w, "ip");
+                cbor_put_text(&w, ip_str);
+            }
+        }
+        return cbor_end(&w, &resp);
+    }
+    
+#if CONFIG_JSON_API_ENABLE
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "status", connected ? "connected" : "disconnected");
+    cJSON_AddBoolToObject(root, "connected", connected);
+    cJSON_AddStringToObject(root, "ssid", ssid);
+    if (connected) {
+        cJSON_AddNumberToObject(root, "rssi", ap_info.rssi);
+        cJSON_AddStringToObject(root, "bssid", bssid_str);
+        if (ip_str[0]) {
+            cJSON_AddStringToObject(root, "ip", ip_str);
+        }
+    }
+    
+    char *response = cJSON_PrintUnformatted(root);
     httpd_resp_set_type(req, "application/json");
     httpd_resp_sendstr(req, response);
     
-    free(response);
+    cJSON_free(response);
     cJSON_Delete(root);
+#endif
     return ESP_OK;
 }
 
+#if CONFIG_JSON_API_ENABLE
 // 获取已保存的WiFi列表
 static esp_err_t saved_wifi_get_handler(httpd_req_t *req)
 {
@@ -446,104 +814,662 @@ static esp_err_t saved_wifi_get_handler(httpd_req_t *req)
     httpd_resp_set_type(req, "application/json");
     httpd_resp_sendstr(req, response);
 
-    free(response);
+    cJSON_free(response);
     cJSON_Delete(root);
     return ESP_OK;
 }
+#endif /* CONFIG_JSON_API_ENABLE */
 
-// 删除保存的WiFi
-static esp_err_t delete_wifi_post_handler(httpd_req_t *req)
+// 清除所有已保存的STA配置并回到纯AP模式
+static void forget_wifi(void)
 {
-    char buf[100];
-    int ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
-    if (ret <= 0) {
-        return ESP_FAIL;
+    esp_wifi_disconnect();
+    
+    // 清除运行时的WiFi配置
+    wifi_config_t wifi_config;
+    memset(&wifi_config, 0, sizeof(wifi_config_t));
+    esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config);
+    
+    // 清除自定义NVS中的WiFi配置
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open("wifi_config", NVS_READWRITE, &nvs_handle);
+    if (err == ESP_OK) {
+        err = nvs_erase_all(nvs_handle);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
     }
-    buf[ret] = '\0';
-
-    cJSON *root = cJSON_Parse(buf);
-    if (!root) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
-        return ESP_FAIL;
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "删除WiFi配置失败: %s", esp_err_to_name(err));
     }
-
-    cJSON *ssid = cJSON_GetObjectItem(root, "ssid");
-    if (!ssid || !cJSON_IsString(ssid)) {
-        cJSON_Delete(root);
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing or invalid SSID");
-        return ESP_FAIL;
+    
+    // 批量配网保存的凭据一并清除，避免重启后自动连接
+    provision_store_clear_profiles();
+    
+    // 清除连接失败计数
+    if (nvs_open("wifi_state", NVS_READWRITE, &nvs_handle) == ESP_OK) {
+        nvs_set_u8(nvs_handle, "connection_failed", 0);
+        nvs_commit(nvs_handle);
+        nvs_close(nvs_handle);
     }
+    
+    // 将WiFi模式设置回AP模式
+    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_AP));
+    ESP_LOGI(TAG, "WiFi配置已完全删除");
+}
 
-    wifi_config_t wifi_config;
-    if (esp_wifi_get_config(ESP_IF_WIFI_STA, &wifi_config) == ESP_OK) {
-        if (strcmp((char*)wifi_config.sta.ssid, ssid->valuestring) == 0) {
-            // 先断开WiFi连接
-            esp_wifi_disconnect();
-            vTaskDelay(pdMS_TO_TICKS(1000));  // 等待断开连接
-            
-            // 清除运行时的WiFi配置
-            memset(&wifi_config, 0, sizeof(wifi_config_t));
-            esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config);
-            
-            // 清除自定义NVS中的WiFi配置
-            nvs_handle_t nvs_handle;
-            esp_err_t err = nvs_open("wifi_config", NVS_READWRITE, &nvs_handle);
-            if (err == ESP_OK) {
-                err = nvs_erase_all(nvs_handle);
-                if (err == ESP_OK) {
-                    err = nvs_commit(nvs_handle);
-                    ESP_LOGI(TAG, "已清除自定义NVS中的WiFi配置");
-                }
-                nvs_close(nvs_handle);
+// 删除保存的WiFi - 网页(/api/delete)与小程序(/delete_wifi)共用。
+// 请求体带ssid时仅在与当前网络一致时删除(网页)；小程序不带请求体或只发送{}，
+// 没有ssid时直接删除当前网络。请求体格式错误时仍返回400
+static esp_err_t delete_post_handler(httpd_req_t *req)
+{
+    char ssid[33] = "";
+    body_field_t fields[] = {
+        { .key = "ssid", .buf = ssid, .size = sizeof(ssid) },
+    };
+    if (req->content_len > 0) {
+        esp_err_t ret = recv_body(req, fields, 1, NULL, NULL);
+        if (ret != ESP_OK) {
+            send_body_error(req, ret);
+            return ESP_FAIL;
+        }
+    }
+
+    bool match = true;
+    if (fields[0].present) {
+        wifi_config_t wifi_config;
+        match = esp_wifi_get_config(ESP_IF_WIFI_STA, &wifi_config) == ESP_OK &&
+                strcmp((char *)wifi_config.sta.ssid, ssid) == 0;
+    }
+    if (match) {
+        forget_wifi();
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, match ? "{\"status\":\"success\",\"message\":\"WiFi配置已删除\"}"
+                                  : "{\"status\":\"success\",\"message\":\"未找到该WiFi配置\"}");
+    return ESP_OK;
+}
+
+#if CONFIG_JSON_API_ENABLE
+// 检查请求头中的令牌，失败时已发送错误响应。
+// 令牌为空时禁用对应接口；逐字节比较全部内容，耗时与不匹配位置无关
+static esp_err_t check_token(httpd_req_t *req, const char *header, const char *expected)
+{
+    size_t expected_len = strlen(expected);
+    char token[65] = {0};
+    if (expected_len == 0) {
+        httpd_resp_send_err(req, HTTPD_403_FORBIDDEN, "Disabled");
+        return ESP_FAIL;
+    }
+    if (httpd_req_get_hdr_value_str(req, header, token, sizeof(token)) != ESP_OK ||
+        strlen(token) != expected_len) {
+        httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Invalid token");
+        return ESP_FAIL;
+    }
+    uint8_t diff = 0;
+    for (size_t i = 0; i < expected_len; i++) {
+        diff |= (uint8_t)(token[i] ^ expected[i]);
+    }
+    if (diff != 0) {
+        httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Invalid token");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+// 解析十进制设置值，空串、非数字或超出范围时返回false
+static bool parse_setting(const char *text, long min, long max, uint8_t *out)
+{
+    char *end;
+    long v = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || v < min || v > max) {
+        return false;
+    }
+    *out = (uint8_t)v;
+    return true;
+}
+
+// 批量配网条目回调：凭据、设备设置和校验和分别出现在不同的对象中
+static esp_err_t collect_batch_item(body_field_t *fields, size_t count, void *arg)
+{
+    batch_ctx_t *ctx = (batch_ctx_t *)arg;
+
+    if (fields[0].present || fields[1].present) {
+        size_t idx = ctx->items++;
+        ctx->crc = provision_checksum_profile(ctx->crc, ctx->ssid, ctx->password);
+        // 超出上限的条目只计数，结果中统一报告too many profiles，整批不保存
+        if (idx >= BATCH_MAX_ITEMS) {
+            return ESP_OK;
+        }
+        strlcpy(ctx->item_ssid[idx], ctx->ssid, sizeof(ctx->item_ssid[idx]));
+
+        size_t pw_len = strlen(ctx->password);
+        batch_item_err_t item_err = BATCH_ITEM_OK;
+        if (ctx->ssid[0] == '\0') {
+            item_err = BATCH_ITEM_MISSING_SSID;
+        } else if (pw_len > 0 && (pw_len < 8 || pw_len > 63)) {
+            item_err = BATCH_ITEM_BAD_PASSWORD;
+        }
+        for (int i = 0; item_err == BATCH_ITEM_OK && i < ctx->data.count; i++) {
+            if (strcmp(ctx->data.profiles[i].ssid, ctx->ssid) == 0) {
+                item_err = BATCH_ITEM_DUPLICATE;
             }
-            
-            // 清除连接失败计数
-            err = nvs_open("wifi_state", NVS_READWRITE, &nvs_handle);
-            if (err == ESP_OK) {
-                nvs_set_u8(nvs_handle, "connection_failed", 0);
-                nvs_commit(nvs_handle);
-                nvs_close(nvs_handle);
+        }
+        ctx->item_err[idx] = item_err;
+        if (item_err == BATCH_ITEM_OK) {
+            wifi_profile_t *profile = &ctx->data.profiles[ctx->data.count++];
+            strlcpy(profile->ssid, ctx->ssid, sizeof(profile->ssid));
+            strlcpy(profile->password, ctx->password, sizeof(profile->password));
+        }
+    }
+
+    if (fields[2].present || fields[3].present) {
+        ctx->has_settings = true;
+        if (fields[2].present) {
+            ctx->has_max_retry = true;
+            if (!parse_setting(ctx->max_retry, 1, PROVISION_MAX_RETRY, &ctx->data.settings.max_retry)) {
+                ctx->settings_err = BATCH_ITEM_BAD_SETTING;
             }
-            
-            // 停止并重启WiFi以确保配置被完全清除
-            esp_wifi_stop();
-            vTaskDelay(pdMS_TO_TICKS(500));
-            esp_wifi_start();
-            
-            ESP_LOGI(TAG, "WiFi配置已完全删除");
         }
+        if (fields[3].present) {
+            ctx->has_ap_channel = true;
+            if (!parse_setting(ctx->ap_channel, 0, 13, &ctx->data.settings.ap_channel)) {
+                ctx->settings_err = BATCH_ITEM_BAD_SETTING;
+            }
+        }
+    }
+
+    if (fields[4].present) {
+        ctx->has_checksum = true;
+    }
+    return ESP_OK;
+}
+
+// 同时写入单网络配置键，保证重启后按第一组凭据连接
+static esp_err_t save_primary_sta_config(const wifi_config_t *wifi_config)
+{
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open("wifi_config", NVS_READWRITE, &nvs_handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs_handle, "sta_config", wifi_config, sizeof(wifi_config_t));
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+    return err;
+}
+
+// 批量配网 - 一次提交多组凭据和设备设置，全部校验通过才整体保存
+static esp_err_t batch_post_handler(httpd_req_t *req)
+{
+    batch_ctx_t *ctx = req_alloc(req, sizeof(batch_ctx_t));
+    if (ctx == NULL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to allocate memory");
+        return ESP_FAIL;
+    }
+    memset(ctx, 0, sizeof(batch_ctx_t));
+
+    // 未在请求中出现的设置沿用当前值
+    provision_data_t current;
+    provision_store_load(&current);
+    ctx->data.settings = current.settings;
+
+    body_field_t fields[] = {
+        { .key = "ssid",       .buf = ctx->ssid,       .size = sizeof(ctx->ssid) },
+        { .key = "password",   .buf = ctx->password,   .size = sizeof(ctx->password) },
+        { .key = "max_retry",  .buf = ctx->max_retry,  .size = sizeof(ctx->max_retry) },
+        { .key = "ap_channel", .buf = ctx->ap_channel, .size = sizeof(ctx->ap_channel) },
+        { .key = "checksum",   .buf = ctx->checksum,   .size = sizeof(ctx->checksum) },
+    };
+    esp_err_t err = recv_body(req, fields, 5, collect_batch_item, ctx);
+    if (err != ESP_OK) {
+        send_body_error(req, err);
+        return ESP_FAIL;
     }
 
+    // 未提交的设置沿用设备上的值，客户端不知道这些值，不计入校验和
+    uint32_t expected = ctx->crc;
+    if (ctx->has_max_retry) {
+        expected = provision_checksum_setting(expected, "max_retry", ctx->data.settings.max_retry);
+    }
+    if (ctx->has_ap_channel) {
+        expected = provision_checksum_setting(expected, "ap_channel", ctx->data.settings.ap_channel);
+    }
+    bool checksum_ok = ctx->has_checksum && strtoul(ctx->checksum, NULL, 16) == expected;
+
+    bool items_ok = (ctx->items > 0 || ctx->has_settings) && ctx->items <= BATCH_MAX_ITEMS &&
+                    ctx->settings_err == BATCH_ITEM_OK;
+    for (size_t i = 0; i < ctx->items && i < BATCH_MAX_ITEMS; i++) {
+        items_ok = items_ok && ctx->item_err[i] == BATCH_ITEM_OK;
+    }
+
+    const char *message = "批量配置已保存";
+    bool ok = false;
+    esp_err_t connect_err = ESP_OK;
+    if (ctx->items > BATCH_MAX_ITEMS) {
+        message = "too many profiles, nothing saved";
+    } else if (!checksum_ok) {
+        message = "checksum mismatch";
+    } else if (!items_ok) {
+        message = "validation failed, nothing saved";
+    } else {
+        // 只提交设置时保留已有凭据
+        if (ctx->items == 0) {
+            ctx->data.count = current.count;
+            memcpy(ctx->data.profiles, current.profiles, sizeof(current.profiles));
+        }
+        ok = (provision_store_save(&ctx->data) == ESP_OK);
+        if (!ok) {
+            message = "保存批量配置失败";
+        }
+    }
+
+    if (ok) {
+        wifi_manager_set_max_retry(ctx->data.settings.max_retry);
+        if (ctx->items > 0) {
+            wifi_config_t wifi_config = {0};
+            strlcpy((char *)wifi_config.sta.ssid, ctx->data.profiles[0].ssid, sizeof(wifi_config.sta.ssid));
+            strlcpy((char *)wifi_config.sta.password, ctx->data.profiles[0].password, sizeof(wifi_config.sta.password));
+            if (save_primary_sta_config(&wifi_config) != ESP_OK) {
+                ESP_LOGE(TAG, "保存WiFi配置失败");
+            }
+            // 配置已经保存，连接失败(如扫描正占用射频)时只报告，重试或重启后仍按新配置连接
+            connect_err = wifi_connect_sta(&wifi_config);
+            if (connect_err != ESP_OK) {
+                ESP_LOGE(TAG, "连接%s失败: %s", wifi_config.sta.ssid, esp_err_to_name(connect_err));
+            }
+        }
+        ESP_LOGI(TAG, "批量配网完成，共%d组凭据", ctx->data.count);
+    }
+
+    // 逐条返回校验结果
+    char crc_str[9];
+    snprintf(crc_str, sizeof(crc_str), "%08lx", (unsigned long)expected);
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "status", ok ? "success" : "error");
+    cJSON_AddStringToObject(root, "message", message);
+    cJSON_AddNumberToObject(root, "applied", ok ? ctx->data.count : 0);
+    cJSON_AddStringToObject(root, "checksum", crc_str);
+    if (connect_err != ESP_OK) {
+        cJSON_AddStringToObject(root, "connect_error", esp_err_to_name(connect_err));
+    }
+    cJSON *results = cJSON_AddArrayToObject(root, "results");
+    for (size_t i = 0; i < ctx->items; i++) {
+        uint8_t item_err = i < BATCH_MAX_ITEMS ? ctx->item_err[i] : BATCH_ITEM_TOO_MANY;
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddNumberToObject(item, "index", i);
+        if (i < BATCH_MAX_ITEMS) {
+            cJSON_AddStringToObject(item, "ssid", ctx->item_ssid[i]);
+        }
+        cJSON_AddBoolToObject(item, "ok", item_err == BATCH_ITEM_OK);
+        if (item_err != BATCH_ITEM_OK) {
+            cJSON_AddStringToObject(item, "error", s_batch_errors[item_err]);
+        }
+        cJSON_AddItemToArray(results, item);
+    }
+    if (ctx->has_settings) {
+        cJSON *settings = cJSON_AddObjectToObject(root, "settings");
+        cJSON_AddBoolToObject(settings, "ok", ctx->settings_err == BATCH_ITEM_OK);
+        if (ctx->settings_err != BATCH_ITEM_OK) {
+            cJSON_AddStringToObject(settings, "error", s_batch_errors[ctx->settings_err]);
+        }
+    }
+
+    char *response = cJSON_PrintUnformatted(root);
+    if (!ok) {
+        httpd_resp_set_status(req, HTTPD_400);
+    }
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, response);
+
+    cJSON_free(response);
     cJSON_Delete(root);
-    httpd_resp_sendstr(req, "{\"status\":\"ok\"}");
     return ESP_OK;
 }
 
-// 获取WiFi状态 - 微信小程序接口
-static esp_err_t get_status_handler(httpd_req_t *req)
+// 导出批量配网数据，可直接POST到下一台设备的 /api/batch。
+// 响应包含明文密码，需要X-Export-Token，且不允许跨域读取
+static esp_err_t batch_get_handler(httpd_req_t *req)
 {
-    wifi_ap_record_t ap_info;
-    char *response = NULL;
+    if (check_token(req, "X-Export-Token", CONFIG_BATCH_EXPORT_TOKEN) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    provision_data_t data;
+    provision_store_load(&data);
+
+    // 只通过单网络接口配置过的设备，导出当前保存的那一组
+    if (data.count == 0) {
+        wifi_config_t sta_config;
+        size_t size = sizeof(sta_config);
+        nvs_handle_t nvs_handle;
+        if (nvs_open("wifi_config", NVS_READONLY, &nvs_handle) == ESP_OK) {
+            if (nvs_get_blob(nvs_handle, "sta_config", &sta_config, &size) == ESP_OK &&
+                sta_config.sta.ssid[0] != '\0') {
+                strlcpy(data.profiles[0].ssid, (char *)sta_config.sta.ssid, sizeof(data.profiles[0].ssid));
+                strlcpy(data.profiles[0].password, (char *)sta_config.sta.password, sizeof(data.profiles[0].password));
+                data.count = 1;
+            }
+            nvs_close(nvs_handle);
+        }
+    }
+
+    char crc_str[9];
+    snprintf(crc_str, sizeof(crc_str), "%08lx", (unsigned long)provision_checksum(&data));
+
     cJSON *root = cJSON_CreateObject();
-    
-    if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-        cJSON_AddStringToObject(root, "ssid", (char *)ap_info.ssid);
-        cJSON_AddBoolToObject(root, "connected", true);
-    } else {
-        cJSON_AddStringToObject(root, "ssid", "");
-        cJSON_AddBoolToObject(root, "connected", false);
+    cJSON *profiles = cJSON_AddArrayToObject(root, "profiles");
+    for (int i = 0; i < data.count; i++) {
+        cJSON *profile = cJSON_CreateObject();
+        cJSON_AddStringToObject(profile, "ssid", data.profiles[i].ssid);
+        cJSON_AddStringToObject(profile, "password", data.profiles[i].password);
+        cJSON_AddItemToArray(profiles, profile);
     }
-    
-    response = cJSON_PrintUnformatted(root);
+    cJSON *settings = cJSON_AddObjectToObject(root, "settings");
+    cJSON_AddNumberToObject(settings, "max_retry", data.settings.max_retry);
+    cJSON_AddNumberToObject(settings, "ap_channel", data.settings.ap_channel);
+    cJSON_AddStringToObject(root, "checksum", crc_str);
+
+    char *response = cJSON_PrintUnformatted(root);
     httpd_resp_set_type(req, "application/json");
-    // 添加CORS头，允许小程序访问
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
     httpd_resp_sendstr(req, response);
-    
-    free(response);
+
+    cJSON_free(response);
     cJSON_Delete(root);
     return ESP_OK;
 }
+#endif /* CONFIG_JSON_API_ENABLE */
+
+#if CONFIG_SCAN_HISTORY_ENABLE || CONFIG_LINK_MONITOR_ENABLE || CONFIG_AP_CHANNEL_AUTO
+static esp_err_t chunk_flush(chunk_resp_t *h)
+{
+    esp_err_t err = httpd_resp_send_chunk(h->req, h->buf, h->len);
+    h->len = 0;
+    return err;
+}
+
+// 确保还能写下一个元素，返回非ESP_OK表示客户端已断开
+static esp_err_t chunk_reserve(chunk_resp_t *h)
+{
+    if (sizeof(h->buf) - h->len < CHUNK_RESP_RESERVE) {
+        return chunk_flush(h);
+    }
+    return ESP_OK;
+}
+#endif
+
+#if CONFIG_SCAN_HISTORY_ENABLE
+static esp_err_t history_emit(const scan_record_t *rec, void *ctx)
+{
+    chunk_resp_t *h = (chunk_resp_t *)ctx;
+    if (chunk_reserve(h) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    h->len += snprintf(h->buf + h->len, sizeof(h->buf) - h->len,
+                       "%s{\"time\":%lu,\"boot\":%u,\"bssid\":\"%02x:%02x:%02x:%02x:%02x:%02x\","
+                       "\"channel\":%u,\"rssi\":%d,\"authmode\":%u}",
+                       h->count ? "," : "", (unsigned long)rec->time, rec->boot,
+                       rec->bssid[0], rec->bssid[1], rec->bssid[2],
+                       rec->bssid[3], rec->bssid[4], rec->bssid[5],
+                       rec->channel, rec->rssi, rec->authmode);
+    h->count++;
+    return ESP_OK;
+}
+
+// 导出扫描历史 - 支持 from/to(秒) 和 bssid 过滤，逐块读取并分块发送
+static esp_err_t scan_history_get_handler(httpd_req_t *req)
+{
+    scan_filter_t filter = {0};
+    char query[96];
+    char value[24];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "from", value, sizeof(value)) == ESP_OK) {
+            filter.from = strtoul(value, NULL, 10);
+        }
+        if (httpd_query_key_value(query, "to", value, sizeof(value)) == ESP_OK) {
+            filter.to = strtoul(value, NULL, 10);
+        }
+        if (httpd_query_key_value(query, "bssid", value, sizeof(value)) == ESP_OK) {
+            unsigned int b[6];
+            // 查询参数中的冒号可能被编码为%3A
+            if (sscanf(value, "%2x:%2x:%2x:%2x:%2x:%2x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6 &&
+                sscanf(value, "%2x%%3A%2x%%3A%2x%%3A%2x%%3A%2x%%3A%2x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6 &&
+                sscanf(value, "%2x%%3a%2x%%3a%2x%%3a%2x%%3a%2x%%3a%2x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) {
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid bssid");
+                return ESP_FAIL;
+            }
+            for (int i = 0; i < 6; i++) {
+                filter.bssid[i] = (uint8_t)b[i];
+            }
+            filter.has_bssid = true;
+        }
+    }
+
+    chunk_resp_t *h = req_alloc(req, sizeof(chunk_resp_t));
+    if (h == NULL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to allocate memory");
+        return ESP_FAIL;
+    }
+    h->req = req;
+    h->count = 0;
+    h->len = snprintf(h->buf, sizeof(h->buf), "{\"now\":%lu,\"boot\":%u,\"records\":[",
+                      (unsigned long)time(NULL), scan_history_boot_count());
+
+    httpd_resp_set_type(req, "application/json");
+    esp_err_t err = scan_history_read(&filter, history_emit, h);
+    if (err == ESP_OK) {
+        h->len += snprintf(h->buf + h->len, sizeof(h->buf) - h->len, "]}");
+        err = chunk_flush(h);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "导出扫描历史中断: %s", esp_err_to_name(err));
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+#endif /* CONFIG_SCAN_HISTORY_ENABLE */
+
+#if CONFIG_LINK_MONITOR_ENABLE
+// 链路质量 - 平均RSSI、趋势、漫游次数以及环形缓冲区中的采样
+// samples为[时间,RSSI]，disconnects为[时间,断开原因]，时间为开机后的秒数
+static esp_err_t link_get_handler(httpd_req_t *req)
+{
+    lq_monitor_t *lq = req_alloc(req, sizeof(lq_monitor_t));
+    chunk_resp_t *h = req_alloc(req, sizeof(chunk_resp_t));
+    if (lq == NULL || h == NULL || link_monitor_snapshot(lq) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Link monitor unavailable");
+        return ESP_FAIL;
+    }
+
+    uint32_t now = (uint32_t)(esp_timer_get_time() / 1000000);
+    h->req = req;
+    h->len = snprintf(h->buf, sizeof(h->buf),
+                      "{\"now\":%lu,\"rssi\":%d,\"trend\":%d,\"roams\":%lu,\"disconnects\":%lu,\"samples\":[",
+                      (unsigned long)now, lq_average(lq), lq_trend(lq, now),
+                      (unsigned long)lq->roams, (unsigned long)lq->disconnects);
+    httpd_resp_set_type(req, "application/json");
+
+    // 两遍输出，分别列出RSSI采样和断开事件
+    esp_err_t err = ESP_OK;
+    lq_sample_t sample;
+    for (int pass = 0; pass < 2 && err == ESP_OK; pass++) {
+        uint8_t type = pass == 0 ? LQ_SAMPLE_RSSI : LQ_SAMPLE_DISCONNECT;
+        h->count = 0;
+        if (pass == 1) {
+            h->len += snprintf(h->buf + h->len, sizeof(h->buf) - h->len, "],\"disconnect_log\":[");
+        }
+        for (uint32_t i = 0; lq_get(lq, i, &sample) && err == ESP_OK; i++) {
+            if (sample.type != type) {
+                continue;
+            }
+            err = chunk_reserve(h);
+            h->len += snprintf(h->buf + h->len, sizeof(h->buf) - h->len, "%s[%lu,%d]",
+                               h->count++ ? "," : "", (unsigned long)sample.ts, sample.value);
+        }
+    }
+    if (err == ESP_OK) {
+        h->len += snprintf(h->buf + h->len, sizeof(h->buf) - h->len, "]}");
+        err = chunk_flush(h);
+    }
+    if (err != ESP_OK) {
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+#endif /* CONFIG_LINK_MONITOR_ENABLE */
+
+#if CONFIG_AP_CHANNEL_AUTO
+// SoftAP信道 - 当前信道、来源和最近一次扫描的评分
+// scores和aps从1信道开始，survey为[信道,RSSI]，可整理成tools/channel_replay的输入
+static esp_err_t channel_get_handler(httpd_req_t *req)
+{
+    channel_planner_status_t *st = req_alloc(req, sizeof(channel_planner_status_t));
+    chunk_resp_t *h = req_alloc(req, sizeof(chunk_resp_t));
+    if (st == NULL || h == NULL || channel_planner_snapshot(st) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Channel planner unavailable");
+        return ESP_FAIL;
+    }
+
+    h->req = req;
+    h->len = snprintf(h->buf, sizeof(h->buf),
+                      "{\"channel\":%u,\"mode\":\"%s\",\"max_channel\":%u,\"surveyed_at\":%lu,"
+                      "\"surveys\":%lu,\"switches\":%lu,\"scores\":[",
+                      st->channel, channel_planner_mode_name(st->mode), st->max_channel,
+                      (unsigned long)st->surveyed_at, (unsigned long)st->surveys,
+                      (unsigned long)st->switches);
+    httpd_resp_set_type(req, "application/json");
+
+    // 每个元素写入前确认剩余空间，缓冲区满时先发送一块
+    esp_err_t err = ESP_OK;
+    for (uint8_t ch = 1; ch <= st->max_channel && err == ESP_OK; ch++) {
+        err = chunk_reserve(h);
+        h->len += snprintf(h->buf + h->len, sizeof(h->buf) - h->len, "%s%lu", ch > 1 ? "," : "",
+                           (unsigned long)st->plan.score[ch]);
+    }
+    if (err == ESP_OK) {
+        h->len += snprintf(h->buf + h->len, sizeof(h->buf) - h->len, "],\"aps\":[");
+    }
+    for (uint8_t ch = 1; ch <= st->max_channel && err == ESP_OK; ch++) {
+        err = chunk_reserve(h);
+        h->len += snprintf(h->buf + h->len, sizeof(h->buf) - h->len, "%s%u", ch > 1 ? "," : "",
+                           st->plan.aps[ch]);
+    }
+    if (err == ESP_OK) {
+        h->len += snprintf(h->buf + h->len, sizeof(h->buf) - h->len, "],\"survey\":[");
+    }
+    for (uint8_t i = 0; i < st->survey_count && err == ESP_OK; i++) {
+        err = chunk_reserve(h);
+        h->len += snprintf(h->buf + h->len, sizeof(h->buf) - h->len, "%s[%u,%d]", i ? "," : "",
+                           st->survey[i].channel, st->survey[i].rssi);
+    }
+    if (err == ESP_OK) {
+        h->len += snprintf(h->buf + h->len, sizeof(h->buf) - h->len, "]}");
+        err = chunk_flush(h);
+    }
+    if (err != ESP_OK) {
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+#endif /* CONFIG_AP_CHANNEL_AUTO */
+
+// 轻量探测接口 - 仅返回设备ID、固件版本和连接状态，代替下载整个index.html
+static esp_err_t ping_get_handler(httpd_req_t *req)
+{
+    char info[96];
+    char response[100];
+    device_info_format_json(info, sizeof(info));
+    snprintf(response, sizeof(response), "{%s}", info);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, response);
+    return ESP_OK;
+}
+
+// HTTP连接统计 - 当前连接数、连接复用率、淘汰次数以及请求内存的使用情况
+static esp_err_t http_stats_get_handler(httpd_req_t *req)
+{
+    char sessions[192];
+    char response[384];
+    http_session_format_json(req->handle, sessions, sizeof(sessions));
+    snprintf(response, sizeof(response),
+             "{%s,\"arena_size\":%d,\"arena_peak\":%d,\"arena_overflows\":%lu,\"pool_failures\":%lu,"
+             "\"resp_pool_free\":%u,\"scan_pool_free\":%u}",
+             sessions, (int)s_arena.size, (int)s_arena.peak, (unsigned long)s_arena.overflows,
+             (unsigned long)(s_resp_pool.failures + s_scan_pool.failures),
+             mem_pool_available(&s_resp_pool), mem_pool_available(&s_scan_pool));
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, response);
+    return ESP_OK;
+}
+
+#if CONFIG_TRACE_LOG_ENABLE
+// 导出跟踪日志 - 默认为文本，?format=bin 时输出原始二进制记录供主机端解码
+static esp_err_t logs_get_handler(httpd_req_t *req)
+{
+    char query[32];
+    char format[8] = {0};
+    bool binary = false;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "format", format, sizeof(format)) == ESP_OK) {
+        binary = (strcmp(format, "bin") == 0);
+    }
+
+    char buf[512];
+    size_t used = 0;
+    uint32_t cursor = 0;
+    trace_record_t rec;
+
+    if (binary) {
+        httpd_resp_set_type(req, "application/octet-stream");
+        trace_dump_header_t header = {
+            .magic = TRACE_DUMP_MAGIC,
+            .record_size = sizeof(trace_record_t),
+            .count = 0,  // 流式输出，记录数由接收端按长度计算
+        };
+        memcpy(buf, &header, sizeof(header));
+        used = sizeof(header);
+    } else {
+        httpd_resp_set_type(req, "text/plain");
+    }
+
+    // 批量拼接到栈缓冲区后再发送，避免每条记录一次socket写
+    while (trace_log_read(&cursor, &rec)) {
+        if (binary) {
+            if (used + sizeof(rec) > sizeof(buf)) {
+                if (httpd_resp_send_chunk(req, buf, used) != ESP_OK) {
+                    return ESP_FAIL;
+                }
+                used = 0;
+            }
+            memcpy(buf + used, &rec, sizeof(rec));
+            used += sizeof(rec);
+        } else {
+            char line[128];
+            int n = trace_log_format(&rec, line, sizeof(line));
+            if (n <= 0) {
+                continue;
+            }
+            n = MIN(n, (int)sizeof(line) - 1);
+            if (used + n > sizeof(buf)) {
+                if (httpd_resp_send_chunk(req, buf, used) != ESP_OK) {
+                    return ESP_FAIL;
+                }
+                used = 0;
+            }
+            memcpy(buf + used, line, n);
+            used += n;
+        }
+    }
+
+    if (used > 0 && httpd_resp_send_chunk(req, buf, used) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+#endif /* CONFIG_TRACE_LOG_ENABLE */
 
 // 检查WiFi配置是否已存在
 static bool is_wifi_config_exists(const char* ssid, const char* password) {
@@ -566,84 +1492,240 @@ static bool is_wifi_config_exists(const char* ssid, const char* password) {
     return false;
 }
 
-// URI处理结构
-static const httpd_uri_t root = {
-    .uri       = "/",
-    .method    = HTTP_GET,
-    .handler   = root_get_handler,
-    .user_ctx  = NULL
-};
+#if CONFIG_WEB_UI_ENABLE
+// 上传新的Web页面 - 边接收边写入非活动槽位，SHA-256校验通过后切换
+static esp_err_t ui_upload_post_handler(httpd_req_t *req)
+{
+    if (check_token(req, "X-Upload-Token", CONFIG_UI_UPLOAD_TOKEN) != ESP_OK) {
+        return ESP_FAIL;
+    }
 
-static const httpd_uri_t scan = {
-    .uri       = "/scan",
-    .method    = HTTP_GET,
-    .handler   = scan_get_handler,
-    .user_ctx  = NULL
-};
+    char sha_hex[65];
+    if (httpd_req_get_hdr_value_str(req, "X-Content-SHA256", sha_hex, sizeof(sha_hex)) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing X-Content-SHA256");
+        return ESP_FAIL;
+    }
+    if (req->content_len == 0 || req->content_len > UI_MAX_SIZE) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid content length");
+        return ESP_FAIL;
+    }
 
-static const httpd_uri_t api_scan = {
-    .uri       = "/api/scan",
-    .method    = HTTP_GET,
-    .handler   = scan_get_handler,
-    .user_ctx  = NULL
-};
+    ui_upload_t *up = req_alloc(req, sizeof(ui_upload_t));
+    char *buf = mem_pool_alloc(&s_resp_pool);
+    if (up == NULL || buf == NULL) {
+        mem_pool_free(&s_resp_pool, buf);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to allocate memory");
+        return ESP_FAIL;
+    }
 
-static const httpd_uri_t configure_old = {
-    .uri       = "/configure",
-    .method    = HTTP_POST,
-    .handler   = configure_post_handler,
-    .user_ctx  = NULL
-};
+    esp_err_t err = ui_upload_begin(up, sha_hex);
+    if (err != ESP_OK) {
+        mem_pool_free(&s_resp_pool, buf);
+        httpd_resp_send_err(req, err == ESP_ERR_INVALID_ARG ? HTTPD_400_BAD_REQUEST : HTTPD_500_INTERNAL_SERVER_ERROR,
+                            err == ESP_ERR_INVALID_ARG ? "Invalid X-Content-SHA256" : "Failed to open slot");
+        return ESP_FAIL;
+    }
 
-static const httpd_uri_t configure = {
-    .uri       = "/api/connect",
-    .method    = HTTP_POST,
-    .handler   = configure_post_handler,
-    .user_ctx  = NULL
-};
+    // 固定缓冲区循环接收，内存占用与文件大小无关
+    size_t remaining = req->content_len;
+    int timeouts = 0;
+    const char *reason = "Failed to write slot";
+    while (remaining > 0 && err == ESP_OK) {
+        int ret = httpd_req_recv(req, buf, MIN(remaining, CHUNK_SIZE));
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+            if (++timeouts >= RECV_TIMEOUT_RETRIES) {
+                err = ESP_ERR_TIMEOUT;
+                reason = "Upload timed out";
+            }
+            continue;  // 短暂超时，继续接收
+        }
+        if (ret <= 0) {
+            err = ESP_FAIL;
+            reason = "Failed to receive data";
+            break;
+        }
+        timeouts = 0;
+        remaining -= ret;
+        err = ui_upload_write(up, buf, ret);
+    }
+    mem_pool_free(&s_resp_pool, buf);
 
-static const httpd_uri_t wechat_config = {
-    .uri       = "/config",
-    .method    = HTTP_POST,
-    .handler   = config_post_handler,
-    .user_ctx  = NULL
-};
+    // 中途失败时删除写了一半的槽位，活动页面不受影响
+    if (err != ESP_OK) {
+        ui_upload_abort(up);
+        ESP_LOGE(TAG, "页面上传失败: %s", esp_err_to_name(err));
+        httpd_resp_send_err(req, err == ESP_ERR_TIMEOUT ? HTTPD_408_REQ_TIMEOUT : HTTPD_500_INTERNAL_SERVER_ERROR,
+                            reason);
+        return ESP_FAIL;
+    }
 
-static const httpd_uri_t wifi_status = {
-    .uri       = "/api/status",
-    .method    = HTTP_GET,
-    .handler   = wifi_status_get_handler,
-    .user_ctx  = NULL
-};
+    err = ui_upload_finish(up);
+    if (err == ESP_ERR_INVALID_CRC) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "SHA-256 mismatch");
+        return ESP_FAIL;
+    }
+    if (err != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to activate slot");
+        return ESP_FAIL;
+    }
 
-static const httpd_uri_t saved_wifi = {
-    .uri       = "/api/saved",
-    .method    = HTTP_GET,
-    .handler   = saved_wifi_get_handler,
-    .user_ctx  = NULL
-};
+    char response[48];
+    snprintf(response, sizeof(response), "{\"status\":\"success\",\"size\":%d}", (int)req->content_len);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, response);
+    return ESP_OK;
+}
+#endif /* CONFIG_WEB_UI_ENABLE */
 
-static const httpd_uri_t delete_wifi = {
-    .uri       = "/api/delete",
-    .method    = HTTP_POST,
-    .handler   = delete_wifi_post_handler,
-    .user_ctx  = NULL
-};
+// 路由属性，由分发函数统一设置对应的响应头
+#define ROUTE_CORS      (1 << 0)   // 允许跨域访问(小程序、调试页面)
+#define ROUTE_NO_STORE  (1 << 1)   // Cache-Control: no-store
+#define ROUTE_VARY      (1 << 2)   // 响应按Accept在JSON/CBOR之间切换
+#define ROUTE_POLL      (1 << 3)   // 轮询接口，连接按轮询类别保留
+#define ROUTE_PROVISION (1 << 4)   // 配网流程中的接口，连接最后被淘汰
 
-static const httpd_uri_t get_status = {
-    .uri       = "/get_status",
-    .method    = HTTP_GET,
-    .handler   = get_status_handler,
-    .user_ctx  = NULL
-};
+#define ROUTE_API       (ROUTE_CORS | ROUTE_NO_STORE)
+#define ROUTE_BUCKETS   (64)       // 路径哈希表大小，2的幂且至少为路由数的两倍
+
+// 路由表项
+typedef struct {
+    httpd_method_t method;
+    const char *path;
+    esp_err_t (*handler)(httpd_req_t *req);
+    uint8_t flags;
+} route_t;
 
-static const httpd_uri_t wechat_delete = {
-    .uri       = "/delete_wifi",
-    .method    = HTTP_POST,
-    .handler   = wechat_delete_wifi_handler,
-    .user_ctx  = NULL
+// 路由表：新增接口只需加一行，不占用httpd的URI处理器槽位。
+// 同一处理函数的多个路径互为别名，属性必须一致
+static const route_t s_routes[] = {
+#if CONFIG_WEB_UI_ENABLE
+    { HTTP_GET,  "/",                 root_get_handler,         0 },
+    { HTTP_POST, "/api/ui",           ui_upload_post_handler,   ROUTE_NO_STORE | ROUTE_PROVISION },
+#endif
+    { HTTP_GET,  "/api/scan",         scan_get_handler,         ROUTE_API | ROUTE_VARY | ROUTE_PROVISION },
+    { HTTP_POST, "/api/connect",      connect_post_handler,     ROUTE_API | ROUTE_PROVISION },
+    { HTTP_GET,  "/api/status",       status_get_handler,       ROUTE_API | ROUTE_VARY | ROUTE_POLL },
+    { HTTP_POST, "/api/delete",       delete_post_handler,      ROUTE_API },
+    { HTTP_GET,  "/api/ping",         ping_get_handler,         ROUTE_API | ROUTE_POLL },
+    { HTTP_GET,  "/api/http",         http_stats_get_handler,   ROUTE_API },
+#if CONFIG_TRACE_LOG_ENABLE
+    { HTTP_GET,  "/api/logs",         logs_get_handler,         ROUTE_NO_STORE },
+#endif
+#if CONFIG_JSON_API_ENABLE
+    { HTTP_GET,  "/api/saved",        saved_wifi_get_handler,   ROUTE_API },
+    { HTTP_POST, "/api/batch",        batch_post_handler,       ROUTE_API | ROUTE_PROVISION },
+    { HTTP_GET,  "/api/batch",        batch_get_handler,        ROUTE_NO_STORE },
+#endif
+#if CONFIG_SCAN_HISTORY_ENABLE
+    { HTTP_GET,  "/api/scan/history", scan_history_get_handler, ROUTE_NO_STORE },
+#endif
+#if CONFIG_LINK_MONITOR_ENABLE
+    { HTTP_GET,  "/api/link",         link_get_handler,         ROUTE_NO_STORE },
+#endif
+#if CONFIG_AP_CHANNEL_AUTO
+    { HTTP_GET,  "/api/channel",      channel_get_handler,      ROUTE_NO_STORE },
+#endif
+    // 微信小程序使用的路径
+    { HTTP_POST, "/config",           connect_post_handler,     ROUTE_API | ROUTE_PROVISION },
+    { HTTP_GET,  "/get_status",       status_get_handler,       ROUTE_API | ROUTE_VARY | ROUTE_POLL },
+    { HTTP_POST, "/delete_wifi",      delete_post_handler,      ROUTE_API },
+#if CONFIG_HTTP_LEGACY_ROUTES
+    // 旧版网页使用的路径
+    { HTTP_GET,  "/scan",             scan_get_handler,         ROUTE_API | ROUTE_VARY | ROUTE_PROVISION },
+    { HTTP_POST, "/configure",        connect_post_handler,     ROUTE_API | ROUTE_PROVISION },
+#endif
 };
 
+#define ROUTE_COUNT  (sizeof(s_routes) / sizeof(s_routes[0]))
+_Static_assert(ROUTE_COUNT * 2 <= ROUTE_BUCKETS, "ROUTE_BUCKETS too small");
+
+// 按路径哈希的开放寻址表，存放路由下标加一，0为空
+static uint8_t s_route_buckets[ROUTE_BUCKETS];
+
+// FNV-1a
+static uint32_t route_hash(const char *path, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (uint8_t)path[i]) * 16777619u;
+    }
+    return h;
+}
+
+static void route_table_init(void)
+{
+    memset(s_route_buckets, 0, sizeof(s_route_buckets));
+    for (size_t i = 0; i < ROUTE_COUNT; i++) {
+        uint32_t slot = route_hash(s_routes[i].path, strlen(s_routes[i].path)) & (ROUTE_BUCKETS - 1);
+        while (s_route_buckets[slot] != 0) {
+            slot = (slot + 1) & (ROUTE_BUCKETS - 1);
+        }
+        s_route_buckets[slot] = i + 1;
+    }
+}
+
+// 查找路径和方法都匹配的路由；same_path返回路径匹配的任一路由，用于区分404和405
+static const route_t *route_find(const char *path, size_t len, int method, const route_t **same_path)
+{
+    *same_path = NULL;
+    uint32_t slot = route_hash(path, len) & (ROUTE_BUCKETS - 1);
+    while (s_route_buckets[slot] != 0) {
+        const route_t *route = &s_routes[s_route_buckets[slot] - 1];
+        if (strncmp(route->path, path, len) == 0 && route->path[len] == '\0') {
+            if (route->method == method) {
+                return route;
+            }
+            *same_path = route;
+        }
+        slot = (slot + 1) & (ROUTE_BUCKETS - 1);
+    }
+    return NULL;
+}
+
+// 唯一注册到httpd的处理函数：查表后统一设置响应头，再调用各接口的处理函数
+static esp_err_t route_dispatch(httpd_req_t *req)
+{
+    size_t len = strcspn(req->uri, "?");
+    const route_t *same_path;
+    const route_t *route = route_find(req->uri, len, req->method, &same_path);
+
+    if (route == NULL) {
+        // CORS预检请求
+        if (req->method == HTTP_OPTIONS && same_path && (same_path->flags & ROUTE_CORS)) {
+            httpd_resp_set_status(req, "204 No Content");
+            httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+            httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+            httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type, Accept");
+            httpd_resp_set_hdr(req, "Access-Control-Max-Age", "600");
+            return httpd_resp_send(req, NULL, 0);
+        }
+        if (same_path) {
+            return httpd_resp_send_err(req, HTTPD_405_METHOD_NOT_ALLOWED, "Method not allowed");
+        }
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Not found");
+    }
+
+    http_session_touch(req, (route->flags & ROUTE_PROVISION) ? HTTP_SESS_PROVISION :
+                            (route->flags & ROUTE_POLL) ? HTTP_SESS_POLL : HTTP_SESS_BROWSER);
+
+    if (route->flags & ROUTE_CORS) {
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    }
+    if (route->flags & ROUTE_NO_STORE) {
+        httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    }
+    if (route->flags & ROUTE_VARY) {
+        httpd_resp_set_hdr(req, "Vary", "Accept");
+    }
+
+    req->user_ctx = &s_arena;
+    s_arena_task = xTaskGetCurrentTaskHandle();
+    esp_err_t err = route->handler(req);
+    s_arena_task = NULL;
+    mem_arena_reset(&s_arena);
+    return err;
+}
+
 // 启动Web服务器
 esp_err_t start_webserver(void)
 {
@@ -655,26 +1737,40 @@ esp_err_t start_webserver(void)
     }
     ESP_ERROR_CHECK(ret);
 
+    static const httpd_method_t methods[] = { HTTP_GET, HTTP_POST, HTTP_OPTIONS };
+    const size_t method_count = sizeof(methods) / sizeof(methods[0]);
+
     httpd_config_t server_config = HTTPD_DEFAULT_CONFIG();
-    server_config.lru_purge_enable = true;
-    server_config.max_uri_handlers = 15;  // 增加处理器数量
-    server_config.server_port = 8080;
+    http_session_config(&server_config);
+    server_config.max_uri_handlers = method_count;  // 每种方法一个通配处理器
+    server_config.uri_match_fn = httpd_uri_match_wildcard;
+    server_config.server_port = WEB_SERVER_PORT;
 
+    route_table_init();
+    mem_arena_init(&s_arena, s_arena_buf, sizeof(s_arena_buf));
+    mem_pool_init(&s_resp_pool, s_resp_buf, CHUNK_SIZE, RESP_POOL_BLOCKS);
+    mem_pool_init(&s_scan_pool, s_scan_buf, sizeof(s_scan_buf), 1);
+    scan_delta_init(&s_scan_delta, esp_random() & 0x7FFFFFFF);
+#if CONFIG_JSON_API_ENABLE
+    cJSON_Hooks hooks = {
+        .malloc_fn = json_malloc,
+        .free_fn = json_free,
+    };
+    cJSON_InitHooks(&hooks);
+#endif
     ESP_LOGI(TAG, "Starting server on port: '%d'", server_config.server_port);
     
     if (httpd_start(&server, &server_config) == ESP_OK) {
-        ESP_LOGI(TAG, "Registering URI handlers");
-        httpd_register_uri_handler(server, &root);
-        httpd_register_uri_handler(server, &scan);        // 旧的扫描路径
-        httpd_register_uri_handler(server, &api_scan);    // 新的API扫描路径
-        httpd_register_uri_handler(server, &configure_old); // 旧的配置路径
-        httpd_register_uri_handler(server, &configure);     // 新的API配置路径
-        httpd_register_uri_handler(server, &wechat_config);  // 微信小程序配置路径
-        httpd_register_uri_handler(server, &wifi_status);
-        httpd_register_uri_handler(server, &saved_wifi);
-        httpd_register_uri_handler(server, &delete_wifi);
-        httpd_register_uri_handler(server, &get_status);  // 获取状态路径
-        httpd_register_uri_handler(server, &wechat_delete);  // 微信小程序删除WiFi路径
+        ESP_LOGI(TAG, "Registering %d routes", (int)ROUTE_COUNT);
+        httpd_uri_t uri = {
+            .uri      = "/*",
+            .handler  = route_dispatch,
+            .user_ctx = NULL,
+        };
+        for (size_t i = 0; i < method_count; i++) {
+            uri.method = methods[i];
+            httpd_register_uri_handler(server, &uri);
+        }
         return ESP_OK;
     }
     
@@ -11,6 +11,7 @@
 
 #define FILE_PATH_MAX (128 + 128)
 #define CHUNK_SIZE    (4096)
+#define WEB_SERVER_PORT (8080)
 
 // 启动Web服务器
 esp_err_t start_webserver(void);
@@ -0,0 +1,182 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 19:00:00
+ * @Description: HTTP连接会话管理实现
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "lwip/sockets.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "mem_pool.h"
+#include "http_session.h"
+
+static const char *TAG = "http_session";
+
+#define SESS_MAX_SOCKETS     7     // 与HTTPD_DEFAULT_CONFIG一致，受LWIP_MAX_SOCKETS限制
+#define SESS_SWEEP_INTERVAL  5     // 秒，两次空闲检查的最短间隔
+#define TCP_KEEP_IDLE        10    // 秒，手机离开热点后尽快发现并释放socket
+#define TCP_KEEP_INTERVAL    5
+#define TCP_KEEP_COUNT       3
+
+// 各类连接的空闲时限(秒)
+static const uint16_t s_idle_limit[] = {
+    [HTTP_SESS_NEW]       = 10,
+    [HTTP_SESS_BROWSER]   = 30,
+    [HTTP_SESS_POLL]      = 20,
+    [HTTP_SESS_PROVISION] = 120,   // 扫描后输入密码可能需要较长时间
+};
+
+// 挂在sess_ctx上的会话记录，随连接关闭由httpd释放
+typedef struct {
+    uint32_t last;          // 最后一次活动时间(秒)
+    uint32_t requests;
+    uint8_t kind;
+} http_sess_t;
+
+// 连接统计
+static struct {
+    uint32_t accepted;          // 累计建立的连接
+    uint32_t requests;          // 累计请求数
+    uint32_t reused;            // 复用已有连接的请求数
+    uint32_t evicted;           // 连接将满时主动关闭的连接
+    uint32_t idle_closed;       // 超过空闲时限关闭的连接
+} s_stats;
+static uint16_t s_max_sockets = SESS_MAX_SOCKETS;
+static http_sess_t s_sess_buf[SESS_MAX_SOCKETS];
+static mem_pool_t s_sess_pool;
+static uint32_t s_last_sweep = 0;
+
+static uint32_t now_s(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+static void sess_free(void *ctx)
+{
+    mem_pool_free(&s_sess_pool, ctx);
+}
+
+// 关闭超过空闲时限的连接；make_room时若连接数仍达到上限，
+// 再关闭一个最不重要的非配网连接(类别低者优先，其次最久未活动)
+static void sweep(httpd_handle_t hd, int except_fd, bool make_room)
+{
+    int fds[SESS_MAX_SOCKETS];
+    size_t count = SESS_MAX_SOCKETS;
+    if (httpd_get_client_list(hd, &count, fds) != ESP_OK) {
+        return;
+    }
+
+    uint32_t now = now_s();
+    size_t open = count;
+    int victim = -1;
+    const http_sess_t *victim_sess = NULL;
+    for (size_t i = 0; i < count; i++) {
+        if (fds[i] == except_fd) {
+            continue;
+        }
+        const http_sess_t *sess = httpd_sess_get_ctx(hd, fds[i]);
+        if (sess == NULL) {
+            continue;
+        }
+        if (now - sess->last > s_idle_limit[sess->kind]) {
+            httpd_sess_trigger_close(hd, fds[i]);
+            s_stats.idle_closed++;
+            open--;
+            continue;
+        }
+        if (sess->kind != HTTP_SESS_PROVISION &&
+            (victim_sess == NULL || sess->kind < victim_sess->kind ||
+             (sess->kind == victim_sess->kind && sess->last < victim_sess->last))) {
+            victim = fds[i];
+            victim_sess = sess;
+        }
+    }
+
+    // 全部是配网连接时不处理，交给httpd的LRU清理
+    if (make_room && open >= s_max_sockets && victim >= 0) {
+        ESP_LOGD(TAG, "连接已满，关闭socket %d(类别%d)", victim, victim_sess->kind);
+        httpd_sess_trigger_close(hd, victim);
+        s_stats.evicted++;
+    }
+}
+
+// 新连接回调：设置socket选项并挂上会话记录
+static esp_err_t sess_open(httpd_handle_t hd, int sockfd)
+{
+    // 响应都很小，关闭Nagle避免与客户端的延迟确认叠加
+    int one = 1;
+    setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    int idle = TCP_KEEP_IDLE;
+    int interval = TCP_KEEP_INTERVAL;
+    int count = TCP_KEEP_COUNT;
+    setsockopt(sockfd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+    setsockopt(sockfd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+    setsockopt(sockfd, IPPROTO_TCP, TCP_KEEPINTVL, &interval, sizeof(interval));
+    setsockopt(sockfd, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count));
+
+    http_sess_t *sess = mem_pool_alloc(&s_sess_pool);
+    if (sess == NULL) {
+        return ESP_ERR_NO_MEM;  // 拒绝该连接
+    }
+    memset(sess, 0, sizeof(http_sess_t));
+    sess->last = now_s();
+    httpd_sess_set_ctx(hd, sockfd, sess, sess_free);
+    s_stats.accepted++;
+
+    sweep(hd, sockfd, true);
+    s_last_sweep = sess->last;
+    return ESP_OK;
+}
+
+void http_session_config(httpd_config_t *config)
+{
+    config->max_open_sockets = SESS_MAX_SOCKETS;
+    config->lru_purge_enable = true;    // 兜底，正常情况下总有一个空位
+    config->open_fn = sess_open;
+    s_max_sockets = config->max_open_sockets;
+    mem_pool_init(&s_sess_pool, s_sess_buf, sizeof(http_sess_t), SESS_MAX_SOCKETS);
+}
+
+void http_session_touch(httpd_req_t *req, http_sess_kind_t kind)
+{
+    uint32_t now = now_s();
+    http_sess_t *sess = (http_sess_t *)req->sess_ctx;
+
+    s_stats.requests++;
+    if (sess != NULL) {
+        if (sess->requests++ > 0) {
+            s_stats.reused++;
+        }
+        sess->last = now;
+        if (kind > sess->kind) {
+            sess->kind = kind;  // 类别只升不降，配网过程中的轮询不会降低优先级
+        }
+    }
+
+    if (now - s_last_sweep >= SESS_SWEEP_INTERVAL) {
+        s_last_sweep = now;
+        sweep(req->handle, httpd_req_to_sockfd(req), false);
+    }
+}
+
+int http_session_format_json(httpd_handle_t server, char *buf, size_t size)
+{
+    int fds[SESS_MAX_SOCKETS];
+    size_t open = SESS_MAX_SOCKETS;
+    if (httpd_get_client_list(server, &open, fds) != ESP_OK) {
+        open = 0;
+    }
+
+    // 复用率按千分比计算，避免浮点
+    uint32_t permille = s_stats.requests ? (uint32_t)((uint64_t)s_stats.reused * 1000 / s_stats.requests) : 0;
+    return snprintf(buf, size,
+                    "\"open\":%d,\"max\":%d,\"accepted\":%lu,\"requests\":%lu,\"reused\":%lu,"
+                    "\"reuse_ratio\":%lu.%03lu,\"evicted\":%lu,\"idle_closed\":%lu",
+                    (int)open, s_max_sockets, (unsigned long)s_stats.accepted,
+                    (unsigned long)s_stats.requests, (unsigned long)s_stats.reused,
+                    (unsigned long)(permille / 1000), (unsigned long)(permille % 1000),
+                    (unsigned long)s_stats.evicted, (unsigned long)s_stats.idle_closed);
+}
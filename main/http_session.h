@@ -0,0 +1,37 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 19:00:00
+ * @Description: HTTP连接会话管理
+ *
+ * 每个socket通过sess_ctx挂一个会话记录，按访问的接口把连接分为浏览、轮询和配网三类。
+ * 连接数将满时主动关闭最久未活动的浏览/轮询连接，始终留出一个空位，
+ * 避免httpd的LRU清理关掉正在配网的连接；各类连接按各自的空闲时限关闭。
+ * 所有函数都在httpd任务中调用，无需加锁。
+ */
+
+#ifndef _HTTP_SESSION_H_
+#define _HTTP_SESSION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+// 连接类别，数值越大越晚被淘汰
+typedef enum {
+    HTTP_SESS_NEW = 0,          // 尚未收到请求
+    HTTP_SESS_BROWSER,          // 页面、日志等一次性访问
+    HTTP_SESS_POLL,             // 状态轮询
+    HTTP_SESS_PROVISION,        // 扫描、配网、上传
+} http_sess_kind_t;
+
+// 设置连接数上限和新连接回调，在httpd_start之前调用
+void http_session_config(httpd_config_t *config);
+
+// 记录一次请求，kind为该接口对应的连接类别
+void http_session_touch(httpd_req_t *req, http_sess_kind_t kind);
+
+// 输出统计和当前连接数的JSON字段(不含花括号)，返回写入长度
+int http_session_format_json(httpd_handle_t server, char *buf, size_t size);
+
+#endif /* _HTTP_SESSION_H_ */
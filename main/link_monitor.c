@@ -0,0 +1,244 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 18:00:00
+ * @Description: STA链路质量监测与主动漫游实现
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_event.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "wifi_manager.h"
+#include "link_monitor.h"
+#if CONFIG_SCAN_HISTORY_ENABLE
+#include "scan_history.h"
+#endif
+
+static const char *TAG = "link_monitor";
+
+#define MONITOR_TASK_STACK   3072
+#define MONITOR_TASK_PRIO    3
+#define ROAM_FAST_DROP       (-6)   // dB/分钟
+#define ROAM_HOLDOFF         60     // 秒，同时也是两次漫游扫描的最短间隔
+#define ROAM_SCAN_MAX        8
+
+static const lq_params_t s_params = {
+    .rssi_threshold = CONFIG_LINK_ROAM_RSSI_THRESHOLD,
+    .hysteresis = CONFIG_LINK_ROAM_HYSTERESIS,
+    .fast_drop = ROAM_FAST_DROP,
+    .holdoff = ROAM_HOLDOFF,
+};
+
+static SemaphoreHandle_t s_lock = NULL;   // 保护s_lq、s_roaming、s_pinned、s_unpin
+static TaskHandle_t s_task = NULL;
+static lq_monitor_t s_lq;
+static uint32_t s_last_scan = 0;
+static bool s_roaming = false;      // 已主动断开，下一次断开事件由漫游引起
+static bool s_pinned = false;       // STA配置当前锁定在某个BSSID
+static bool s_unpin = false;        // 需要由监测任务清除BSSID锁定
+static wifi_ap_record_t s_scan[ROAM_SCAN_MAX];
+
+static uint32_t now_s(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+// 清除BSSID锁定，之后的重连按SSID选择AP，在监测任务中调用，需持有s_lock。
+// 设置失败时保留标记，下一个周期再试
+static void unpin_bssid(void)
+{
+    wifi_config_t cfg;
+    if (esp_wifi_get_config(WIFI_IF_STA, &cfg) != ESP_OK) {
+        return;
+    }
+    if (cfg.sta.bssid_set) {
+        cfg.sta.bssid_set = false;
+        cfg.sta.channel = 0;
+        if (esp_wifi_set_config(WIFI_IF_STA, &cfg) != ESP_OK) {
+            return;
+        }
+    }
+    s_pinned = false;
+    s_unpin = false;
+}
+
+// 事件任务中只记录，修改STA配置交给监测任务
+static void link_event_handler(void *arg, esp_event_base_t event_base,
+                               int32_t event_id, void *event_data)
+{
+    wifi_event_sta_disconnected_t *event = (wifi_event_sta_disconnected_t *)event_data;
+    bool wake = false;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    lq_add_disconnect(&s_lq, now_s(), event->reason);
+    if (s_roaming) {
+        s_roaming = false;  // 漫游主动断开，wifi_manager按锁定的BSSID重连
+    } else if (s_pinned) {
+        // 目标AP连不上或之后掉线时不能一直锁定，之后的重试恢复按SSID连接
+        s_unpin = true;
+        wake = true;
+    }
+    xSemaphoreGive(s_lock);
+    if (wake) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+// 只扫描当前SSID，返回信号最强的其他BSSID
+static bool find_better_ap(const wifi_ap_record_t *current, wifi_ap_record_t *best)
+{
+    wifi_scan_config_t scan_config = {
+        .ssid = (uint8_t *)current->ssid,
+        .bssid = NULL,
+        .channel = 0,
+        .show_hidden = false,
+        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
+        .scan_time.active.min = 50,
+        .scan_time.active.max = 120,
+    };
+    // HTTP扫描或信道选择扫描进行中时等下一个周期
+    if (!wifi_manager_scan_lock(0)) {
+        return false;
+    }
+    uint16_t count = ROAM_SCAN_MAX;
+    esp_err_t err = esp_wifi_scan_start(&scan_config, true);
+    if (err == ESP_OK) {
+        err = esp_wifi_scan_get_ap_records(&count, s_scan);
+    }
+    wifi_manager_scan_unlock();
+    if (err != ESP_OK) {
+        return false;
+    }
+#if CONFIG_SCAN_HISTORY_ENABLE
+    scan_history_append(s_scan, count);
+#endif
+
+    bool found = false;
+    for (int i = 0; i < count; i++) {
+        if (memcmp(s_scan[i].bssid, current->bssid, sizeof(s_scan[i].bssid)) == 0) {
+            continue;
+        }
+        if (!found || s_scan[i].rssi > best->rssi) {
+            *best = s_scan[i];
+            found = true;
+        }
+    }
+    return found;
+}
+
+// 锁定目标BSSID后主动断开，由wifi_manager的重连流程连到新AP
+static void roam_to(const wifi_ap_record_t *target)
+{
+    wifi_config_t cfg;
+    if (esp_wifi_get_config(WIFI_IF_STA, &cfg) != ESP_OK) {
+        return;
+    }
+    cfg.sta.bssid_set = true;
+    memcpy(cfg.sta.bssid, target->bssid, sizeof(cfg.sta.bssid));
+    cfg.sta.channel = target->primary;
+
+    // 锁定配置和标记一起完成，期间到达的断开事件等待后按新的标记处理
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool pinned = esp_wifi_set_config(WIFI_IF_STA, &cfg) == ESP_OK;
+    if (pinned) {
+        s_pinned = true;
+        s_roaming = true;
+        s_unpin = false;
+    }
+    xSemaphoreGive(s_lock);
+    if (!pinned) {
+        return;
+    }
+    wifi_manager_set_roaming(true);
+    if (esp_wifi_disconnect() != ESP_OK) {
+        wifi_manager_set_roaming(false);
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        s_roaming = false;
+        xSemaphoreGive(s_lock);
+    }
+}
+
+static void link_monitor_task(void *arg)
+{
+    while (1) {
+        // 断开事件需要清除BSSID锁定时提前唤醒，处理完继续等待下一次采样
+        bool woken = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONFIG_LINK_MONITOR_INTERVAL * 1000)) != 0;
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        if (s_unpin) {
+            unpin_bssid();
+        }
+        xSemaphoreGive(s_lock);
+        if (woken) {
+            continue;
+        }
+
+        wifi_ap_record_t ap_info;
+        if (wifi_manager_get_state() != WIFI_STATE_CONNECTED ||
+            esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK) {
+            continue;
+        }
+
+        uint32_t now = now_s();
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        lq_add_rssi(&s_lq, now, ap_info.rssi);
+        bool degraded = lq_degraded(&s_lq, &s_params, now);
+        xSemaphoreGive(s_lock);
+
+        if (!degraded || (s_last_scan != 0 && now - s_last_scan < ROAM_HOLDOFF)) {
+            continue;
+        }
+        s_last_scan = now;
+
+        wifi_ap_record_t best;
+        if (!find_better_ap(&ap_info, &best)) {
+            continue;
+        }
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        bool roam = lq_should_roam(&s_lq, &s_params, now, best.rssi);
+        if (roam) {
+            lq_note_roam(&s_lq, now);
+        }
+        int avg = lq_average(&s_lq);
+        xSemaphoreGive(s_lock);
+
+        if (roam) {
+            ESP_LOGI(TAG, "链路变差(平均%d dBm)，漫游到 "MACSTR" (%d dBm, 信道%d)",
+                     avg, MAC2STR(best.bssid), best.rssi, best.primary);
+            roam_to(&best);
+        }
+    }
+}
+
+esp_err_t link_monitor_start(void)
+{
+    if (s_lock != NULL) {
+        return ESP_OK;
+    }
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    lq_init(&s_lq);
+
+    if (xTaskCreate(link_monitor_task, "link_monitor", MONITOR_TASK_STACK, NULL, MONITOR_TASK_PRIO, &s_task) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    // 事件处理函数会唤醒监测任务，任务创建后再注册
+    esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, link_event_handler, NULL);
+    return ESP_OK;
+}
+
+esp_err_t link_monitor_snapshot(lq_monitor_t *out)
+{
+    if (s_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *out = s_lq;
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
@@ -0,0 +1,22 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 18:00:00
+ * @Description: STA链路质量监测与主动漫游
+ *
+ * 连接后台定期采样RSSI，断开时记录原因；链路变差时只扫描当前SSID，
+ * 发现明显更强的BSSID就指定BSSID重连，避免等到掉线再处理。
+ */
+
+#ifndef _LINK_MONITOR_H_
+#define _LINK_MONITOR_H_
+
+#include "esp_err.h"
+#include "link_quality.h"
+
+// 启动监测任务，需在WiFi初始化之后调用
+esp_err_t link_monitor_start(void);
+
+// 复制一份当前统计数据，供接口输出
+esp_err_t link_monitor_snapshot(lq_monitor_t *out);
+
+#endif /* _LINK_MONITOR_H_ */
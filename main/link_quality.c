@@ -0,0 +1,127 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 18:00:00
+ * @Description: STA链路质量统计与漫游判断实现
+ */
+
+#include <string.h>
+#include "link_quality.h"
+
+#define LQ_MASK   (LQ_RING_SIZE - 1)
+
+_Static_assert((LQ_RING_SIZE & LQ_MASK) == 0, "LQ_RING_SIZE must be a power of two");
+
+void lq_init(lq_monitor_t *lq)
+{
+    memset(lq, 0, sizeof(*lq));
+}
+
+static void push(lq_monitor_t *lq, uint32_t ts, lq_sample_type_t type, int16_t value)
+{
+    lq_sample_t *s = &lq->ring[lq->head & LQ_MASK];
+    s->ts = ts;
+    s->value = value;
+    s->type = (uint8_t)type;
+    s->reserved = 0;
+    lq->head++;
+}
+
+void lq_add_rssi(lq_monitor_t *lq, uint32_t ts, int8_t rssi)
+{
+    push(lq, ts, LQ_SAMPLE_RSSI, rssi);
+    // 指数平均，权重1/4，兼顾平滑和响应速度
+    if (lq->since_connect == 0) {
+        lq->avg_x16 = rssi * 16;
+    } else {
+        lq->avg_x16 += (rssi * 16 - lq->avg_x16) / 4;
+    }
+    if (lq->since_connect < UINT16_MAX) {
+        lq->since_connect++;
+    }
+}
+
+void lq_add_disconnect(lq_monitor_t *lq, uint32_t ts, uint8_t reason)
+{
+    push(lq, ts, LQ_SAMPLE_DISCONNECT, reason);
+    lq->since_connect = 0;
+    lq->disconnects++;
+}
+
+int lq_average(const lq_monitor_t *lq)
+{
+    if (lq->since_connect == 0) {
+        return 0;
+    }
+    // 四舍五入到整数dB
+    return (lq->avg_x16 + (lq->avg_x16 < 0 ? -8 : 8)) / 16;
+}
+
+uint32_t lq_count(const lq_monitor_t *lq)
+{
+    return lq->head < LQ_RING_SIZE ? lq->head : LQ_RING_SIZE;
+}
+
+bool lq_get(const lq_monitor_t *lq, uint32_t index, lq_sample_t *out)
+{
+    uint32_t count = lq_count(lq);
+    if (index >= count) {
+        return false;
+    }
+    *out = lq->ring[(lq->head - count + index) & LQ_MASK];
+    return true;
+}
+
+int lq_trend(const lq_monitor_t *lq, uint32_t now)
+{
+    // 从新到旧取本次连接内、时间窗口内的RSSI采样做最小二乘
+    int64_t n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    uint32_t count = lq_count(lq);
+    for (uint32_t i = count; i-- > 0;) {
+        const lq_sample_t *s = &lq->ring[(lq->head - count + i) & LQ_MASK];
+        if (s->type == LQ_SAMPLE_DISCONNECT || now - s->ts > LQ_TREND_WINDOW) {
+            break;
+        }
+        int64_t x = (int64_t)s->ts - now;
+        n++;
+        sx += x;
+        sy += s->value;
+        sxx += x * x;
+        sxy += x * s->value;
+    }
+    int64_t den = n * sxx - sx * sx;
+    if (n < LQ_MIN_SAMPLES || den == 0) {
+        return 0;
+    }
+    // 斜率单位为dB/秒，换算为dB/分钟并四舍五入
+    int64_t num = (n * sxy - sx * sy) * 60;
+    return (int)((num + (num < 0 ? -den / 2 : den / 2)) / den);
+}
+
+bool lq_degraded(const lq_monitor_t *lq, const lq_params_t *params, uint32_t now)
+{
+    if (lq->since_connect < LQ_MIN_SAMPLES) {
+        return false;
+    }
+    if (lq->roams > 0 && now - lq->last_roam < params->holdoff) {
+        return false;
+    }
+    int avg = lq_average(lq);
+    if (avg < params->rssi_threshold) {
+        return true;
+    }
+    // 信号快速下降时提前寻找其他AP，避免等到掉线
+    return avg < params->rssi_threshold + params->hysteresis &&
+           lq_trend(lq, now) <= params->fast_drop;
+}
+
+bool lq_should_roam(const lq_monitor_t *lq, const lq_params_t *params, uint32_t now, int8_t candidate_rssi)
+{
+    return lq_degraded(lq, params, now) &&
+           candidate_rssi >= lq_average(lq) + params->hysteresis;
+}
+
+void lq_note_roam(lq_monitor_t *lq, uint32_t now)
+{
+    lq->last_roam = now;
+    lq->roams++;
+}
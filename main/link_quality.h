@@ -0,0 +1,80 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 18:00:00
+ * @Description: STA链路质量统计与漫游判断
+ *
+ * 定长环形缓冲区保存RSSI采样和断开原因，维护RSSI的指数平均和线性趋势，
+ * 据此判断何时值得切换到同一SSID下信号更强的BSSID。
+ * 只依赖标准C，可以直接在Linux上编译，用记录下来的RSSI序列回放测试。
+ */
+
+#ifndef _LINK_QUALITY_H_
+#define _LINK_QUALITY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LQ_RING_SIZE        128     // 采样数，必须为2的幂
+#define LQ_TREND_WINDOW     60      // 计算趋势的时间窗口(秒)
+#define LQ_MIN_SAMPLES      4       // 重连后至少采样这么多次才做判断
+
+typedef enum {
+    LQ_SAMPLE_RSSI = 0,
+    LQ_SAMPLE_DISCONNECT,
+} lq_sample_type_t;
+
+// 单条采样，断开事件的value为断开原因
+typedef struct {
+    uint32_t ts;        // 秒
+    int16_t value;
+    uint8_t type;
+    uint8_t reserved;
+} lq_sample_t;
+
+typedef struct {
+    int8_t rssi_threshold;      // 平均RSSI低于此值视为链路变差
+    uint8_t hysteresis;         // 候选AP至少比当前强这么多dB才切换
+    int8_t fast_drop;           // 趋势(dB/分钟)低于此值时提前到阈值+hysteresis就判断为变差
+    uint16_t holdoff;           // 两次漫游之间的最短间隔(秒)
+} lq_params_t;
+
+typedef struct {
+    lq_sample_t ring[LQ_RING_SIZE];
+    uint32_t head;              // 已写入的采样总数
+    int32_t avg_x16;            // RSSI指数平均，放大16倍
+    uint16_t since_connect;     // 最近一次断开后的RSSI采样数
+    uint32_t last_roam;
+    uint32_t roams;
+    uint32_t disconnects;
+} lq_monitor_t;
+
+void lq_init(lq_monitor_t *lq);
+
+// 记录一次RSSI采样
+void lq_add_rssi(lq_monitor_t *lq, uint32_t ts, int8_t rssi);
+
+// 记录一次断开，平均值在重连后重新计算
+void lq_add_disconnect(lq_monitor_t *lq, uint32_t ts, uint8_t reason);
+
+// 当前RSSI平均值，没有采样时返回0
+int lq_average(const lq_monitor_t *lq);
+
+// 最近LQ_TREND_WINDOW秒内RSSI的变化趋势(dB/分钟)，采样不足时返回0
+int lq_trend(const lq_monitor_t *lq, uint32_t now);
+
+// 链路是否变差到需要寻找其他AP
+bool lq_degraded(const lq_monitor_t *lq, const lq_params_t *params, uint32_t now);
+
+// 候选AP的RSSI是否足以触发漫游
+bool lq_should_roam(const lq_monitor_t *lq, const lq_params_t *params, uint32_t now, int8_t candidate_rssi);
+
+// 记录已发起漫游
+void lq_note_roam(lq_monitor_t *lq, uint32_t now);
+
+// 按从旧到新的顺序取第index条采样，超出范围返回false
+bool lq_get(const lq_monitor_t *lq, uint32_t index, lq_sample_t *out);
+
+// 环形缓冲区中的采样数
+uint32_t lq_count(const lq_monitor_t *lq);
+
+#endif /* _LINK_QUALITY_H_ */
@@ -11,13 +11,32 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_system.h"
 #include "nvs_flash.h"
-#include "esp_spiffs.h"
+#include "esp_timer.h"
 #include "wifi_manager.h"
 #include "http_server.h"
+#if CONFIG_DISCOVERY_ENABLE
+#include "discovery_server.h"
+#endif
+#if CONFIG_LINK_MONITOR_ENABLE
+#include "link_monitor.h"
+#endif
+#if CONFIG_AP_CHANNEL_AUTO
+#include "channel_planner.h"
+#endif
+#if CONFIG_WEB_UI_ENABLE
+#include "esp_spiffs.h"
+#include "captive_portal.h"
+#include "ui_store.h"
+#endif
+#if CONFIG_SCAN_HISTORY_ENABLE
+#include "scan_history.h"
+#endif
 
 static const char *TAG = "main";
 
+#if CONFIG_WEB_UI_ENABLE
 // 初始化SPIFFS
 static esp_err_t init_spiffs(void)
 {
@@ -52,6 +71,7 @@ static esp_err_t init_spiffs(void)
     ESP_LOGI(TAG, "Partition size: total: %d, used: %d", total, used);
     return ESP_OK;
 }
+#endif
 
 void app_main(void)
 {
@@ -63,14 +83,41 @@ void app_main(void)
     }
     ESP_ERROR_CHECK(ret);
 
-    // 初始化SPIFFS
+#if CONFIG_WEB_UI_ENABLE
+    // 初始化SPIFFS，无界面镜像不挂载
     ESP_ERROR_CHECK(init_spiffs());
+    ui_store_init();
+#endif
+#if CONFIG_SCAN_HISTORY_ENABLE
+    scan_history_init();
+#endif
 
     // 初始化并启动WiFi AP
     ESP_LOGI(TAG, "Starting WiFi in AP mode");
     ESP_ERROR_CHECK(wifi_init_softap());
 
+#if CONFIG_LINK_MONITOR_ENABLE
+    // 监测STA链路质量，信号变差时主动漫游
+    ESP_ERROR_CHECK(link_monitor_start());
+#endif
+#if CONFIG_AP_CHANNEL_AUTO
+    // 把SoftAP放到最空闲的信道，STA连上后跟随路由器信道
+    ESP_ERROR_CHECK(channel_planner_start());
+#endif
+
     // 启动HTTP服务器
     ESP_ERROR_CHECK(start_webserver());
-    ESP_LOGI(TAG, "System initialized successfully");
+
+#if CONFIG_CAPTIVE_PORTAL_ENABLE
+    // 启动强制门户，手机连上热点后自动弹出配网页面
+    ESP_ERROR_CHECK(captive_portal_start());
+#endif
+#if CONFIG_DISCOVERY_ENABLE
+    // 启动局域网发现服务，客户端无需写死设备地址
+    ESP_ERROR_CHECK(discovery_server_start());
+#endif
+
+    // 启动耗时和剩余堆，用于比较不同编译配置
+    ESP_LOGI(TAG, "System initialized successfully in %lld ms, free heap: %lu bytes",
+             esp_timer_get_time() / 1000, (unsigned long)esp_get_free_heap_size());
 }
\ No newline at end of file
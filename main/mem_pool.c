@@ -0,0 +1,84 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 20:00:00
+ * @Description: 定长内存池与请求级线性分配器实现
+ */
+
+#include <string.h>
+#include "mem_pool.h"
+
+#define ARENA_ALIGN  8
+
+void mem_pool_init(mem_pool_t *pool, void *storage, size_t block_size, uint8_t block_count)
+{
+    memset(pool, 0, sizeof(*pool));
+    pool->storage = (uint8_t *)storage;
+    pool->block_size = block_size;
+    pool->block_count = block_count > 32 ? 32 : block_count;
+}
+
+void *mem_pool_alloc(mem_pool_t *pool)
+{
+    for (uint8_t i = 0; i < pool->block_count; i++) {
+        if (!(pool->used & (1u << i))) {
+            pool->used |= (1u << i);
+            return pool->storage + (size_t)i * pool->block_size;
+        }
+    }
+    pool->failures++;
+    return NULL;
+}
+
+void mem_pool_free(mem_pool_t *pool, void *ptr)
+{
+    if (ptr == NULL || (uint8_t *)ptr < pool->storage) {
+        return;
+    }
+    size_t offset = (size_t)((uint8_t *)ptr - pool->storage);
+    size_t index = offset / pool->block_size;
+    if (index < pool->block_count && offset % pool->block_size == 0) {
+        pool->used &= ~(1u << index);
+    }
+}
+
+uint8_t mem_pool_available(const mem_pool_t *pool)
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < pool->block_count; i++) {
+        if (!(pool->used & (1u << i))) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void mem_arena_init(mem_arena_t *arena, void *base, size_t size)
+{
+    memset(arena, 0, sizeof(*arena));
+    arena->base = (uint8_t *)base;
+    arena->size = size;
+}
+
+void *mem_arena_alloc(mem_arena_t *arena, size_t size)
+{
+    size_t start = (arena->used + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (size > arena->size || start > arena->size - size) {
+        arena->overflows++;
+        return NULL;
+    }
+    arena->used = start + size;
+    if (arena->used > arena->peak) {
+        arena->peak = arena->used;
+    }
+    return arena->base + start;
+}
+
+bool mem_arena_owns(const mem_arena_t *arena, const void *ptr)
+{
+    return (const uint8_t *)ptr >= arena->base && (const uint8_t *)ptr < arena->base + arena->size;
+}
+
+void mem_arena_reset(mem_arena_t *arena)
+{
+    arena->used = 0;
+}
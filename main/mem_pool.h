@@ -0,0 +1,59 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 20:00:00
+ * @Description: 定长内存池与请求级线性分配器
+ *
+ * 定长池在启动时一次性分配，按块借出归还，用位图记录占用，块数不超过32。
+ * 线性分配器(arena)只向前移动指针，单个释放为空操作，请求结束时一步复位。
+ * 两者都不加锁，只能在同一个任务中使用；只依赖标准C，可以在主机上编译测试。
+ */
+
+#ifndef _MEM_POOL_H_
+#define _MEM_POOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 定长内存池
+typedef struct {
+    uint8_t *storage;
+    size_t block_size;
+    uint8_t block_count;
+    uint32_t used;              // 占用位图
+    uint32_t failures;          // 池已空时的申请次数
+} mem_pool_t;
+
+// 请求级线性分配器
+typedef struct {
+    uint8_t *base;
+    size_t size;
+    size_t used;
+    size_t peak;                // 历史最大用量
+    uint32_t overflows;         // 空间不足转而使用堆的次数
+} mem_arena_t;
+
+// storage至少为 block_size * block_count 字节，block_size需按指针大小对齐
+void mem_pool_init(mem_pool_t *pool, void *storage, size_t block_size, uint8_t block_count);
+
+// 借出一块，池已空时返回NULL
+void *mem_pool_alloc(mem_pool_t *pool);
+
+// 归还一块，ptr可以为NULL
+void mem_pool_free(mem_pool_t *pool, void *ptr);
+
+// 当前空闲块数
+uint8_t mem_pool_available(const mem_pool_t *pool);
+
+void mem_arena_init(mem_arena_t *arena, void *base, size_t size);
+
+// 按8字节对齐分配，空间不足时返回NULL
+void *mem_arena_alloc(mem_arena_t *arena, size_t size);
+
+// ptr是否位于arena的内存范围内
+bool mem_arena_owns(const mem_arena_t *arena, const void *ptr);
+
+// 一步释放本次请求分配的全部内存
+void mem_arena_reset(mem_arena_t *arena);
+
+#endif /* _MEM_POOL_H_ */
@@ -0,0 +1,128 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 13:00:00
+ * @Description: 批量配网数据存储实现
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "nvs_flash.h"
+#include "provision_store.h"
+
+static const char *TAG = "provision_store";
+
+#define PROVISION_NAMESPACE  "provision"
+#define PROVISION_KEY        "data"
+#define PROVISION_MAGIC      0x50524F56  // "PROV"
+
+// NVS中保存的格式，带魔数和CRC防止读到旧版本或损坏的数据
+typedef struct {
+    uint32_t magic;
+    provision_data_t data;
+    uint32_t crc;
+} provision_blob_t;
+
+static void set_defaults(provision_data_t *data)
+{
+    memset(data, 0, sizeof(*data));
+    data->settings.max_retry = PROVISION_DEFAULT_RETRY;
+    data->settings.ap_channel = 0;
+}
+
+esp_err_t provision_store_load(provision_data_t *data)
+{
+    set_defaults(data);
+
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(PROVISION_NAMESPACE, NVS_READONLY, &nvs_handle);
+    if (err != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    provision_blob_t blob;
+    size_t size = sizeof(blob);
+    err = nvs_get_blob(nvs_handle, PROVISION_KEY, &blob, &size);
+    nvs_close(nvs_handle);
+    if (err != ESP_OK || size != sizeof(blob)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (blob.magic != PROVISION_MAGIC ||
+        blob.crc != esp_rom_crc32_le(0, (const uint8_t *)&blob.data, sizeof(blob.data)) ||
+        blob.data.count > PROVISION_MAX_PROFILES) {
+        ESP_LOGW(TAG, "配网数据校验失败，使用默认值");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    *data = blob.data;
+    return ESP_OK;
+}
+
+esp_err_t provision_store_save(const provision_data_t *data)
+{
+    if (data->count > PROVISION_MAX_PROFILES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    provision_blob_t blob = {0};
+    blob.magic = PROVISION_MAGIC;
+    blob.data = *data;
+    blob.crc = esp_rom_crc32_le(0, (const uint8_t *)&blob.data, sizeof(blob.data));
+
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(PROVISION_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = nvs_set_blob(nvs_handle, PROVISION_KEY, &blob, sizeof(blob));
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "保存配网数据失败: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+esp_err_t provision_store_clear_profiles(void)
+{
+    provision_data_t data;
+    if (provision_store_load(&data) != ESP_OK || data.count == 0) {
+        return ESP_OK;
+    }
+    data.count = 0;
+    memset(data.profiles, 0, sizeof(data.profiles));
+    return provision_store_save(&data);
+}
+
+uint32_t provision_checksum_profile(uint32_t crc, const char *ssid, const char *password)
+{
+    crc = esp_rom_crc32_le(crc, (const uint8_t *)ssid, strlen(ssid) + 1);
+    return esp_rom_crc32_le(crc, (const uint8_t *)password, strlen(password) + 1);
+}
+
+uint32_t provision_checksum_setting(uint32_t crc, const char *key, unsigned value)
+{
+    char text[24];
+    int len = snprintf(text, sizeof(text), "%s=%u", key, value);
+    return esp_rom_crc32_le(crc, (const uint8_t *)text, len + 1);
+}
+
+uint32_t provision_checksum_settings(uint32_t crc, const device_settings_t *settings)
+{
+    crc = provision_checksum_setting(crc, "max_retry", settings->max_retry);
+    return provision_checksum_setting(crc, "ap_channel", settings->ap_channel);
+}
+
+uint32_t provision_checksum(const provision_data_t *data)
+{
+    uint32_t crc = 0;
+    for (int i = 0; i < data->count; i++) {
+        crc = provision_checksum_profile(crc, data->profiles[i].ssid, data->profiles[i].password);
+    }
+    return provision_checksum_settings(crc, &data->settings);
+}
@@ -0,0 +1,58 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 13:00:00
+ * @Description: 批量配网数据存储
+ *
+ * 多组WiFi凭据和设备设置作为一个整体保存在NVS的单个blob中，
+ * NVS对单个键的写入是原子的，断电后只会看到完整的旧数据或新数据。
+ */
+
+#ifndef _PROVISION_STORE_H_
+#define _PROVISION_STORE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#define PROVISION_MAX_PROFILES    5
+#define PROVISION_DEFAULT_RETRY   5
+#define PROVISION_MAX_RETRY       20
+
+// 一组WiFi凭据
+typedef struct {
+    char ssid[33];
+    char password[65];
+} wifi_profile_t;
+
+// 设备设置
+typedef struct {
+    uint8_t max_retry;      // 单个网络的最大重试次数
+    uint8_t ap_channel;     // SoftAP信道，0表示使用Kconfig默认值
+} device_settings_t;
+
+typedef struct {
+    uint8_t count;
+    device_settings_t settings;
+    wifi_profile_t profiles[PROVISION_MAX_PROFILES];
+} provision_data_t;
+
+// 读取配网数据，不存在或校验失败时返回默认值和ESP_ERR_NOT_FOUND
+esp_err_t provision_store_load(provision_data_t *data);
+
+// 整体保存配网数据
+esp_err_t provision_store_save(const provision_data_t *data);
+
+// 清除所有凭据，保留设备设置
+esp_err_t provision_store_clear_profiles(void);
+
+/*
+ * 批量数据校验和(CRC-32，与zlib.crc32一致)
+ * 依次对每组凭据计算 ssid '\0' password '\0'，再对出现的设置按 max_retry、ap_channel 的顺序
+ * 追加 "key=N\0"。导出的数据两项设置都有；提交时只计入请求中实际出现的设置
+ */
+uint32_t provision_checksum_profile(uint32_t crc, const char *ssid, const char *password);
+uint32_t provision_checksum_setting(uint32_t crc, const char *key, unsigned value);
+uint32_t provision_checksum_settings(uint32_t crc, const device_settings_t *settings);
+uint32_t provision_checksum(const provision_data_t *data);
+
+#endif /* _PROVISION_STORE_H_ */
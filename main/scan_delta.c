@@ -0,0 +1,153 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 21:00:00
+ * @Description: 扫描结果的版本与增量实现
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "scan_delta.h"
+
+void scan_delta_init(scan_delta_t *d, uint32_t base)
+{
+    memset(d, 0, sizeof(*d));
+    d->version = base;
+    d->floor = base;
+}
+
+static scan_entry_t *find_entry(scan_delta_t *d, const uint8_t bssid[6])
+{
+    for (uint8_t i = 0; i < d->count; i++) {
+        if (memcmp(d->entries[i].bssid, bssid, 6) == 0) {
+            return &d->entries[i];
+        }
+    }
+    return NULL;
+}
+
+// 移除条目并写入删除记录，覆盖最旧的记录时抬高floor
+static void remove_entry(scan_delta_t *d, uint8_t index)
+{
+    scan_tombstone_t *t = &d->removed[d->removed_head];
+    if (d->removed_count == SCAN_DELTA_TOMBSTONES) {
+        d->floor = t->version;
+    } else {
+        d->removed_count++;
+    }
+    memcpy(t->bssid, d->entries[index].bssid, 6);
+    t->version = d->version + 1;
+    d->removed_head = (d->removed_head + 1) % SCAN_DELTA_TOMBSTONES;
+
+    d->entries[index] = d->entries[--d->count];
+    d->dirty = true;
+}
+
+void scan_delta_begin(scan_delta_t *d)
+{
+    for (uint8_t i = 0; i < d->count; i++) {
+        d->entries[i].seen = false;
+    }
+    d->dirty = false;
+}
+
+void scan_delta_observe(scan_delta_t *d, const uint8_t bssid[6], const char *ssid,
+                        int8_t rssi, uint8_t authmode, uint8_t channel)
+{
+    uint32_t next = d->version + 1;
+    scan_entry_t *e = find_entry(d, bssid);
+    if (e != NULL) {
+        e->seen = true;
+        e->misses = 0;
+        if (abs(rssi - e->rssi) >= SCAN_DELTA_RSSI_STEP || e->authmode != authmode ||
+            e->channel != channel || strncmp(e->ssid, ssid, sizeof(e->ssid) - 1) != 0) {
+            strncpy(e->ssid, ssid, sizeof(e->ssid) - 1);
+            e->rssi = rssi;
+            e->authmode = authmode;
+            e->channel = channel;
+            e->changed = next;
+            d->dirty = true;
+        }
+        return;
+    }
+
+    // 表满时替换信号最弱的条目，新AP不比它强则忽略
+    if (d->count == SCAN_DELTA_MAX) {
+        uint8_t weakest = 0;
+        for (uint8_t i = 1; i < d->count; i++) {
+            if (d->entries[i].rssi < d->entries[weakest].rssi) {
+                weakest = i;
+            }
+        }
+        if (rssi <= d->entries[weakest].rssi) {
+            return;
+        }
+        remove_entry(d, weakest);
+    }
+
+    e = &d->entries[d->count++];
+    memset(e, 0, sizeof(*e));
+    memcpy(e->bssid, bssid, 6);
+    strncpy(e->ssid, ssid, sizeof(e->ssid) - 1);
+    e->rssi = rssi;
+    e->authmode = authmode;
+    e->channel = channel;
+    e->seen = true;
+    e->added = next;
+    e->changed = next;
+    d->dirty = true;
+}
+
+uint32_t scan_delta_end(scan_delta_t *d)
+{
+    for (uint8_t i = 0; i < d->count; ) {
+        scan_entry_t *e = &d->entries[i];
+        if (!e->seen && ++e->misses >= SCAN_DELTA_MISS_LIMIT) {
+            remove_entry(d, i);  // 末尾条目移到了i，不递增
+            continue;
+        }
+        i++;
+    }
+    if (d->dirty) {
+        d->version++;
+        d->dirty = false;
+    }
+    return d->version;
+}
+
+bool scan_delta_can_diff(const scan_delta_t *d, uint32_t since)
+{
+    return since >= d->floor && since <= d->version;
+}
+
+bool scan_delta_removed_since(const scan_delta_t *d, uint32_t since, size_t index, uint8_t bssid[6])
+{
+    // 从旧到新遍历删除记录
+    uint8_t start = (d->removed_head + SCAN_DELTA_TOMBSTONES - d->removed_count) % SCAN_DELTA_TOMBSTONES;
+    for (uint8_t i = 0; i < d->removed_count; i++) {
+        const scan_tombstone_t *t = &d->removed[(start + i) % SCAN_DELTA_TOMBSTONES];
+        if (t->version <= since) {
+            continue;
+        }
+        // 删除后又重新出现的BSSID作为新增返回
+        bool present = false;
+        for (uint8_t j = 0; j < d->count && !present; j++) {
+            present = memcmp(d->entries[j].bssid, t->bssid, 6) == 0;
+        }
+        if (present) {
+            continue;
+        }
+        // 同一BSSID可能被删除多次，只报告最后一次
+        bool later = false;
+        for (uint8_t k = i + 1; k < d->removed_count && !later; k++) {
+            later = memcmp(d->removed[(start + k) % SCAN_DELTA_TOMBSTONES].bssid, t->bssid, 6) == 0;
+        }
+        if (later) {
+            continue;
+        }
+        if (index-- == 0) {
+            memcpy(bssid, t->bssid, 6);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,84 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 21:00:00
+ * @Description: 扫描结果的版本与增量
+ *
+ * 以BSSID为键维护最近的扫描结果表，每次扫描后只有内容变化的条目才记录新版本号，
+ * 被移除的BSSID记入定长的删除记录环。客户端带上已有的版本号时只需取回之后的新增、
+ * 变化和删除；删除记录已被覆盖或版本号不属于本次开机时退回完整列表。
+ * RSSI变化不足SCAN_DELTA_RSSI_STEP时不算变化，连续SCAN_DELTA_MISS_LIMIT次未扫到才移除，
+ * 避免信号的正常波动让每次刷新都变成全量。只依赖标准C，可以在主机上编译测试。
+ */
+
+#ifndef _SCAN_DELTA_H_
+#define _SCAN_DELTA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SCAN_DELTA_MAX          32      // 结果表容量
+#define SCAN_DELTA_TOMBSTONES   32      // 删除记录数
+#define SCAN_DELTA_RSSI_STEP    4       // dB，RSSI变化达到此值才算变化
+#define SCAN_DELTA_MISS_LIMIT   2       // 连续未扫到的次数
+
+typedef struct {
+    uint8_t bssid[6];
+    char ssid[33];
+    int8_t rssi;                // 最近一次记为变化时的RSSI
+    uint8_t authmode;
+    uint8_t channel;
+    uint8_t misses;
+    bool seen;                  // 本次扫描中出现过
+    uint32_t added;             // 加入时的版本号
+    uint32_t changed;           // 最近一次变化的版本号，不小于added
+} scan_entry_t;
+
+typedef struct {
+    uint8_t bssid[6];
+    uint32_t version;
+} scan_tombstone_t;
+
+typedef struct {
+    scan_entry_t entries[SCAN_DELTA_MAX];
+    uint8_t count;
+    scan_tombstone_t removed[SCAN_DELTA_TOMBSTONES];
+    uint8_t removed_head;       // 下一条删除记录的位置
+    uint8_t removed_count;
+    uint32_t version;           // 当前版本号
+    uint32_t floor;             // 早于此版本号的增量已不完整
+    bool dirty;                 // 本次扫描有变化
+} scan_delta_t;
+
+// base为起始版本号，建议取随机数，使上次开机的版本号大概率落在有效范围之外
+void scan_delta_init(scan_delta_t *d, uint32_t base);
+
+// 开始合并一次扫描结果
+void scan_delta_begin(scan_delta_t *d);
+
+// 合并一个扫描到的AP
+void scan_delta_observe(scan_delta_t *d, const uint8_t bssid[6], const char *ssid,
+                        int8_t rssi, uint8_t authmode, uint8_t channel);
+
+// 结束合并，有变化时版本号加一，返回当前版本号
+uint32_t scan_delta_end(scan_delta_t *d);
+
+// 能否给出since之后的增量，否则应返回完整列表
+bool scan_delta_can_diff(const scan_delta_t *d, uint32_t since);
+
+// 条目在since之后是新增的
+static inline bool scan_entry_added_since(const scan_entry_t *e, uint32_t since)
+{
+    return e->added > since;
+}
+
+// 条目在since之后有变化但不是新增的
+static inline bool scan_entry_changed_since(const scan_entry_t *e, uint32_t since)
+{
+    return e->changed > since && e->added <= since;
+}
+
+// 取since之后第index个被删除且当前不在表中的BSSID，超出范围返回false
+bool scan_delta_removed_since(const scan_delta_t *d, uint32_t since, size_t index, uint8_t bssid[6]);
+
+#endif /* _SCAN_DELTA_H_ */
@@ -0,0 +1,275 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 16:00:00
+ * @Description: 扫描历史环形文件实现
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_spiffs.h"
+#include "nvs_flash.h"
+#include "ui_store.h"
+#include "scan_history.h"
+
+static const char *TAG = "scan_history";
+
+#define BLOCK_SIZE        256
+#define BLOCK_MAGIC       0x5348  // "HS"
+#define BLOCK_RECORDS     15
+#define BLOCK_COUNT       (CONFIG_SCAN_HISTORY_SIZE_KB * 1024 / BLOCK_SIZE)
+#define FLUSH_INTERVAL_US (5 * 60 * 1000000LL)  // 未写满的块最长缓存5分钟
+#define SPIFFS_USABLE_PCT 75                    // SPIFFS超过约75%后垃圾回收频繁、写入容易失败
+
+// 文件中的一个块，与SPIFFS页大小一致
+typedef struct {
+    uint32_t seq;                           // 块序号，文件中的位置为 seq % BLOCK_COUNT
+    uint16_t count;                         // 已写入的记录数
+    uint16_t magic;
+    scan_record_t records[BLOCK_RECORDS];
+    uint8_t pad[BLOCK_SIZE - 8 - BLOCK_RECORDS * sizeof(scan_record_t)];
+} scan_block_t;
+
+_Static_assert(sizeof(scan_record_t) == 16, "scan_record_t must be 16 bytes");
+_Static_assert(sizeof(scan_block_t) == BLOCK_SIZE, "scan_block_t must match BLOCK_SIZE");
+
+static SemaphoreHandle_t s_lock = NULL;
+static scan_block_t s_block;                // 正在填充的块，只在内存中
+static bool s_dirty = false;                // s_block有尚未写入文件的记录
+static uint16_t s_boot = 0;
+
+// 启动计数加一
+static void load_boot_count(void)
+{
+    nvs_handle_t nvs_handle;
+    if (nvs_open("scan_hist", NVS_READWRITE, &nvs_handle) == ESP_OK) {
+        nvs_get_u16(nvs_handle, "boot", &s_boot);
+        s_boot++;
+        nvs_set_u16(nvs_handle, "boot", s_boot);
+        nvs_commit(nvs_handle);
+        nvs_close(nvs_handle);
+    }
+}
+
+static esp_err_t write_block(const scan_block_t *block)
+{
+    FILE *fd = fopen(SCAN_HISTORY_PATH, "r+b");
+    if (fd == NULL) {
+        return ESP_FAIL;
+    }
+    // 文件按序号顺序增长，未写满一圈前目标位置总是文件末尾
+    long offset = (long)(block->seq % BLOCK_COUNT) * BLOCK_SIZE;
+    esp_err_t err = ESP_OK;
+    if (fseek(fd, offset, SEEK_SET) != 0 || fwrite(block, BLOCK_SIZE, 1, fd) != 1) {
+        err = ESP_FAIL;
+    }
+    fclose(fd);
+    return err;
+}
+
+// 定时把未写满的块写入文件，断电最多丢失最近几分钟的记录
+static void flush_timer_cb(void *arg)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_dirty) {
+        if (write_block(&s_block) != ESP_OK) {
+            ESP_LOGW(TAG, "写入扫描历史失败");
+        }
+        s_dirty = false;
+    }
+    xSemaphoreGive(s_lock);
+}
+
+// 环形文件与两个页面上传槽位共用storage分区，全部写满后仍要留在可用比例之内
+static bool fits_partition(void)
+{
+    size_t total = 0, used = 0;
+    if (esp_spiffs_info(NULL, &total, &used) != ESP_OK) {
+        return false;
+    }
+    size_t need = (size_t)BLOCK_COUNT * BLOCK_SIZE + 2 * UI_MAX_SIZE;
+    FILE *fd = fopen(UI_FACTORY_PATH, "rb");
+    if (fd != NULL) {
+        fseek(fd, 0, SEEK_END);
+        need += (size_t)ftell(fd);
+        fclose(fd);
+    }
+    size_t budget = total / 100 * SPIFFS_USABLE_PCT;
+    if (need > budget) {
+        ESP_LOGE(TAG, "扫描历史%dKB加上页面槽位需要%u字节，超过分区可用的%u字节，已停用",
+                 CONFIG_SCAN_HISTORY_SIZE_KB, (unsigned)need, (unsigned)budget);
+        return false;
+    }
+    return true;
+}
+
+esp_err_t scan_history_init(void)
+{
+    if (!fits_partition()) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    load_boot_count();
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = flush_timer_cb,
+        .name = "scan_hist",
+    };
+    esp_timer_handle_t timer;
+    if (esp_timer_create(&timer_args, &timer) != ESP_OK ||
+        esp_timer_start_periodic(timer, FLUSH_INTERVAL_US) != ESP_OK) {
+        ESP_LOGW(TAG, "无法启动定时写入，未写满的块只在写满时保存");
+    }
+
+    FILE *fd = fopen(SCAN_HISTORY_PATH, "rb");
+    if (fd == NULL) {
+        fd = fopen(SCAN_HISTORY_PATH, "wb");
+        if (fd == NULL) {
+            ESP_LOGE(TAG, "无法创建 %s", SCAN_HISTORY_PATH);
+            return ESP_FAIL;
+        }
+        fclose(fd);
+        memset(&s_block, 0, sizeof(s_block));
+        s_block.magic = BLOCK_MAGIC;
+        return ESP_OK;
+    }
+
+    // 找到序号最大的块，从它继续写入
+    bool found = false;
+    uint32_t head_seq = 0;
+    struct { uint32_t seq; uint16_t count; uint16_t magic; } hdr;
+    for (uint32_t i = 0; i < BLOCK_COUNT; i++) {
+        if (fseek(fd, (long)i * BLOCK_SIZE, SEEK_SET) != 0 || fread(&hdr, sizeof(hdr), 1, fd) != 1) {
+            break;
+        }
+        if (hdr.magic == BLOCK_MAGIC && hdr.seq % BLOCK_COUNT == i && (!found || hdr.seq > head_seq)) {
+            head_seq = hdr.seq;
+            found = true;
+        }
+    }
+
+    memset(&s_block, 0, sizeof(s_block));
+    s_block.magic = BLOCK_MAGIC;
+    if (found) {
+        fseek(fd, (long)(head_seq % BLOCK_COUNT) * BLOCK_SIZE, SEEK_SET);
+        if (fread(&s_block, BLOCK_SIZE, 1, fd) != 1 || s_block.count > BLOCK_RECORDS) {
+            s_block.count = BLOCK_RECORDS;  // 块损坏时直接开始下一块
+        }
+        if (s_block.count == BLOCK_RECORDS) {
+            memset(&s_block, 0, sizeof(s_block));
+            s_block.magic = BLOCK_MAGIC;
+            s_block.seq = head_seq + 1;
+        }
+    }
+    fclose(fd);
+
+    ESP_LOGI(TAG, "扫描历史: 块%lu/%d，启动计数%d",
+             (unsigned long)s_block.seq, BLOCK_COUNT, s_boot);
+    return ESP_OK;
+}
+
+uint16_t scan_history_boot_count(void)
+{
+    return s_boot;
+}
+
+void scan_history_append(const wifi_ap_record_t *records, uint16_t count)
+{
+    if (s_lock == NULL || count == 0) {
+        return;
+    }
+
+    uint32_t now = (uint32_t)time(NULL);
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (uint16_t i = 0; i < count; i++) {
+        scan_record_t *rec = &s_block.records[s_block.count++];
+        rec->time = now;
+        rec->boot = s_boot;
+        memcpy(rec->bssid, records[i].bssid, sizeof(rec->bssid));
+        rec->channel = records[i].primary;
+        rec->rssi = records[i].rssi;
+        rec->authmode = records[i].authmode;
+        rec->reserved = 0;
+
+        s_dirty = true;
+
+        // 块写满时落盘并开始下一块
+        if (s_block.count == BLOCK_RECORDS) {
+            if (write_block(&s_block) != ESP_OK) {
+                ESP_LOGW(TAG, "写入扫描历史失败");
+            }
+            uint32_t next = s_block.seq + 1;
+            memset(&s_block, 0, sizeof(s_block));
+            s_block.magic = BLOCK_MAGIC;
+            s_block.seq = next;
+            s_dirty = false;
+        }
+    }
+    xSemaphoreGive(s_lock);
+}
+
+static bool record_matches(const scan_record_t *rec, const scan_filter_t *filter)
+{
+    if (filter->from && rec->time < filter->from) {
+        return false;
+    }
+    if (filter->to && rec->time > filter->to) {
+        return false;
+    }
+    if (filter->has_bssid && memcmp(rec->bssid, filter->bssid, sizeof(rec->bssid)) != 0) {
+        return false;
+    }
+    return true;
+}
+
+esp_err_t scan_history_read(const scan_filter_t *filter, scan_history_cb_t cb, void *ctx)
+{
+    if (s_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    uint32_t head_seq = s_block.seq;
+    xSemaphoreGive(s_lock);
+    uint32_t oldest = (head_seq >= BLOCK_COUNT) ? head_seq - BLOCK_COUNT + 1 : 0;
+
+    FILE *fd = fopen(SCAN_HISTORY_PATH, "rb");
+    if (fd == NULL) {
+        return ESP_FAIL;
+    }
+
+    scan_block_t block;
+    esp_err_t err = ESP_OK;
+    for (uint32_t seq = oldest; seq <= head_seq && err == ESP_OK; seq++) {
+        // 读取时持锁，避免读到写了一半的块；正在填充的块取内存中的副本；回调在锁外执行
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        bool ok;
+        if (seq == s_block.seq) {
+            block = s_block;
+            ok = true;
+        } else {
+            ok = fseek(fd, (long)(seq % BLOCK_COUNT) * BLOCK_SIZE, SEEK_SET) == 0 &&
+                 fread(&block, BLOCK_SIZE, 1, fd) == 1;
+        }
+        xSemaphoreGive(s_lock);
+
+        // 读取期间被新一圈覆盖的块序号不符，跳过
+        if (!ok || block.magic != BLOCK_MAGIC || block.seq != seq || block.count > BLOCK_RECORDS) {
+            continue;
+        }
+        for (uint16_t i = 0; i < block.count && err == ESP_OK; i++) {
+            if (record_matches(&block.records[i], filter)) {
+                err = cb(&block.records[i], ctx);
+            }
+        }
+    }
+    fclose(fd);
+    return err;
+}
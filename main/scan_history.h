@@ -0,0 +1,56 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 16:00:00
+ * @Description: 扫描历史环形文件
+ *
+ * 每次扫描的结果以16字节的紧凑记录追加到SPIFFS上固定大小的环形文件中，
+ * 文件按256字节的块写入，块头带递增序号，启动时据此找回写入位置。
+ * 记录先缓存在内存中的当前块，写满时或每5分钟写入一次，扫描本身不触发页改写。
+ * 默认64KB，启动时检查与页面上传槽位合计不超过storage分区的75%，否则停用。
+ */
+
+#ifndef _SCAN_HISTORY_H_
+#define _SCAN_HISTORY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_wifi.h"
+
+#define SCAN_HISTORY_PATH   "/spiffs/scan_hist.bin"
+
+// 单条扫描记录(小端)
+typedef struct __attribute__((packed)) {
+    uint32_t time;          // 系统时间(秒)，未校时时为开机后的秒数
+    uint16_t boot;          // 启动计数，用于区分未校时的不同次开机
+    uint8_t  bssid[6];
+    uint8_t  channel;
+    int8_t   rssi;
+    uint8_t  authmode;
+    uint8_t  reserved;
+} scan_record_t;
+
+// 导出过滤条件，取值为0或has_bssid为false时表示不限
+typedef struct {
+    uint32_t from;
+    uint32_t to;
+    bool has_bssid;
+    uint8_t bssid[6];
+} scan_filter_t;
+
+// 每条匹配记录回调一次，返回非ESP_OK时停止遍历
+typedef esp_err_t (*scan_history_cb_t)(const scan_record_t *rec, void *ctx);
+
+// 打开环形文件并找回写入位置，需在SPIFFS挂载后调用
+esp_err_t scan_history_init(void);
+
+// 本次开机的启动计数
+uint16_t scan_history_boot_count(void);
+
+// 追加一次扫描的结果
+void scan_history_append(const wifi_ap_record_t *records, uint16_t count);
+
+// 从旧到新遍历记录，每次只读入一个块
+esp_err_t scan_history_read(const scan_filter_t *filter, scan_history_cb_t cb, void *ctx);
+
+#endif /* _SCAN_HISTORY_H_ */
@@ -0,0 +1,16 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 09:00:00
+ * @Description: 二进制跟踪事件表
+ *
+ * 每一行 TRACE_EVENT(枚举名, 模块, 格式串) 定义一个事件，事件ID即其在表中的序号。
+ * 格式串在读取时才使用，参数固定为4个int32，格式串中只能使用%d/%u/%x。
+ * tools/trace_decode.py 直接解析本文件，新增事件只能追加在末尾且格式串必须为字面量。
+ */
+
+TRACE_EVENT(TRACE_EVT_LOG_DROPPED,     "trace",        "records overwritten: %u")
+TRACE_EVENT(TRACE_EVT_HTTP_STATUS_IP,  "http_server",  "status poll, ip=%d.%d.%d.%d")
+TRACE_EVENT(TRACE_EVT_HTTP_SCAN_REQ,   "http_server",  "scan request")
+TRACE_EVENT(TRACE_EVT_HTTP_SCAN_DONE,  "http_server",  "scan done, ap_count=%d")
+TRACE_EVENT(TRACE_EVT_SCAN_AP,         "wifi_manager", "ap[%d] rssi=%d channel=%d authmode=%d")
+TRACE_EVENT(TRACE_EVT_SCAN_COUNT,      "wifi_manager", "scan found %d aps")
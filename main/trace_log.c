@@ -0,0 +1,113 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 09:00:00
+ * @Description: 低开销二进制跟踪日志实现
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "trace_log.h"
+
+#if CONFIG_TRACE_LOG_ENABLE
+#define TRACE_DEPTH      CONFIG_TRACE_LOG_DEPTH
+#else
+#define TRACE_DEPTH      1
+#endif
+#define TRACE_MASK       (TRACE_DEPTH - 1)
+
+_Static_assert((TRACE_DEPTH & TRACE_MASK) == 0, "CONFIG_TRACE_LOG_DEPTH必须是2的幂");
+
+// 事件模块名与格式串，仅在读取时使用
+static const char *const s_event_tags[TRACE_EVT_MAX] = {
+#define TRACE_EVENT(id, tag, fmt) [id] = tag,
+#include "trace_events.h"
+#undef TRACE_EVENT
+};
+
+static const char *const s_event_fmts[TRACE_EVT_MAX] = {
+#define TRACE_EVENT(id, tag, fmt) [id] = fmt,
+#include "trace_events.h"
+#undef TRACE_EVENT
+};
+
+static trace_record_t s_ring[TRACE_DEPTH];
+static uint32_t s_head = 0;  // 下一条记录的全局序号
+
+#if CONFIG_TRACE_LOG_ENABLE
+void trace_log_write(uint16_t id, int32_t a0, int32_t a1, int32_t a2, int32_t a3)
+{
+    // 抢占一个槽位，写入者之间互不等待
+    uint32_t idx = __atomic_fetch_add(&s_head, 1, __ATOMIC_RELAXED);
+    trace_record_t *slot = &s_ring[idx & TRACE_MASK];
+
+    // 先标记槽位无效，写完后再发布序号，读取端据此丢弃写了一半的记录
+    __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->ts_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    slot->id = id;
+    slot->reserved = 0;
+    slot->args[0] = a0;
+    slot->args[1] = a1;
+    slot->args[2] = a2;
+    slot->args[3] = a3;
+    __atomic_store_n(&slot->seq, idx + 1, __ATOMIC_RELEASE);
+}
+#endif
+
+bool trace_log_read(uint32_t *cursor, trace_record_t *out)
+{
+    uint32_t head = __atomic_load_n(&s_head, __ATOMIC_ACQUIRE);
+
+    // 游标落后超过缓冲区深度，说明旧记录已被覆盖，先报告丢失数量
+    if (head - *cursor > TRACE_DEPTH) {
+        uint32_t lost = head - TRACE_DEPTH - *cursor;
+        *cursor = head - TRACE_DEPTH;
+        memset(out, 0, sizeof(*out));
+        out->id = TRACE_EVT_LOG_DROPPED;
+        out->args[0] = (int32_t)lost;
+        return true;
+    }
+
+    while (*cursor != head) {
+        uint32_t idx = (*cursor)++;
+        const trace_record_t *slot = &s_ring[idx & TRACE_MASK];
+
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != idx + 1) {
+            continue;  // 正在写入或已被覆盖
+        }
+        memcpy(out, slot, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != idx + 1) {
+            continue;  // 拷贝过程中被覆盖
+        }
+        out->seq = idx + 1;
+        return true;
+    }
+    return false;
+}
+
+int trace_log_format(const trace_record_t *rec, char *buf, size_t len)
+{
+    if (rec->id >= TRACE_EVT_MAX) {
+        return snprintf(buf, len, "(%lu) ? unknown event %u\n",
+                        (unsigned long)rec->ts_ms, rec->id);
+    }
+
+    int n = snprintf(buf, len, "(%lu) %s: ", (unsigned long)rec->ts_ms, s_event_tags[rec->id]);
+    if (n < 0 || (size_t)n >= len) {
+        return n;
+    }
+    // 格式串固定使用4个int参数，多余参数会被忽略
+    int m = snprintf(buf + n, len - n, s_event_fmts[rec->id],
+                     (int)rec->args[0], (int)rec->args[1], (int)rec->args[2], (int)rec->args[3]);
+    if (m < 0) {
+        return m;
+    }
+    n += m;
+    if ((size_t)n + 1 < len) {
+        buf[n++] = '\n';
+        buf[n] = '\0';
+    }
+    return n;
+}
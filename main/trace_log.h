@@ -0,0 +1,73 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 09:00:00
+ * @Description: 低开销二进制跟踪日志
+ *
+ * 热路径只写入定长二进制记录(时间戳、事件ID、4个整型参数)到无锁环形缓冲区，
+ * 格式化推迟到读取 /api/logs 或主机端解码时进行。
+ */
+
+#ifndef _TRACE_LOG_H_
+#define _TRACE_LOG_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+
+// 事件ID
+typedef enum {
+#define TRACE_EVENT(id, tag, fmt) id,
+#include "trace_events.h"
+#undef TRACE_EVENT
+    TRACE_EVT_MAX
+} trace_event_id_t;
+
+// 单条跟踪记录，导出的二进制格式与此结构一致(小端)
+typedef struct {
+    uint32_t seq;       // 写入序号+1，0表示槽位正在写入
+    uint32_t ts_ms;     // 时间戳(毫秒)
+    uint16_t id;        // 事件ID
+    uint16_t reserved;
+    int32_t  args[4];   // 事件参数
+} trace_record_t;
+
+// 二进制导出头
+#define TRACE_DUMP_MAGIC   0x31525454  // "TTR1"
+typedef struct {
+    uint32_t magic;
+    uint16_t record_size;
+    uint16_t count;
+} trace_dump_header_t;
+
+#if CONFIG_TRACE_LOG_ENABLE
+
+// 写入一条记录，可在任意任务中调用，不阻塞、不格式化
+void trace_log_write(uint16_t id, int32_t a0, int32_t a1, int32_t a2, int32_t a3);
+
+#define TRACE_0(id)                  trace_log_write((id), 0, 0, 0, 0)
+#define TRACE_1(id, a)               trace_log_write((id), (a), 0, 0, 0)
+#define TRACE_2(id, a, b)            trace_log_write((id), (a), (b), 0, 0)
+#define TRACE_3(id, a, b, c)         trace_log_write((id), (a), (b), (c), 0)
+#define TRACE_4(id, a, b, c, d)      trace_log_write((id), (a), (b), (c), (d))
+
+#else
+
+#define TRACE_0(id)                  do { } while (0)
+#define TRACE_1(id, a)               do { (void)(a); } while (0)
+#define TRACE_2(id, a, b)            do { (void)(a); (void)(b); } while (0)
+#define TRACE_3(id, a, b, c)         do { (void)(a); (void)(b); (void)(c); } while (0)
+#define TRACE_4(id, a, b, c, d)      do { (void)(a); (void)(b); (void)(c); (void)(d); } while (0)
+
+#endif
+
+/*
+ * 按从旧到新的顺序取出当前缓冲区中的记录
+ * cursor 为读取游标，首次传入0，返回false表示已读完
+ */
+bool trace_log_read(uint32_t *cursor, trace_record_t *out);
+
+// 将一条记录格式化为文本行，返回写入长度
+int trace_log_format(const trace_record_t *rec, char *buf, size_t len);
+
+#endif /* _TRACE_LOG_H_ */
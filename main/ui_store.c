@@ -0,0 +1,154 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 15:00:00
+ * @Description: Web界面资源的双槽存储实现
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "ui_store.h"
+
+static const char *TAG = "ui_store";
+
+#define UI_NAMESPACE      "ui_store"
+#define UI_KEY_ACTIVE     "active"
+#define UI_SLOT_NONE      0xFF
+
+static const char *const s_slot_paths[2] = {
+    "/spiffs/ui_a.html",
+    "/spiffs/ui_b.html",
+};
+
+static uint8_t s_active = UI_SLOT_NONE;
+
+esp_err_t ui_store_init(void)
+{
+    nvs_handle_t nvs_handle;
+    if (nvs_open(UI_NAMESPACE, NVS_READONLY, &nvs_handle) == ESP_OK) {
+        uint8_t active = UI_SLOT_NONE;
+        if (nvs_get_u8(nvs_handle, UI_KEY_ACTIVE, &active) == ESP_OK && active < 2) {
+            s_active = active;
+        }
+        nvs_close(nvs_handle);
+    }
+
+    // 活动槽位文件丢失时退回出厂页面
+    if (s_active != UI_SLOT_NONE) {
+        FILE *fd = fopen(s_slot_paths[s_active], "r");
+        if (fd == NULL) {
+            ESP_LOGW(TAG, "槽位%d的页面不存在，使用出厂页面", s_active);
+            s_active = UI_SLOT_NONE;
+        } else {
+            fclose(fd);
+        }
+    }
+    ESP_LOGI(TAG, "当前页面: %s", ui_store_active_path());
+    return ESP_OK;
+}
+
+const char *ui_store_active_path(void)
+{
+    return s_active == UI_SLOT_NONE ? UI_FACTORY_PATH : s_slot_paths[s_active];
+}
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+esp_err_t ui_upload_begin(ui_upload_t *up, const char *expected_sha256)
+{
+    memset(up, 0, sizeof(*up));
+    if (strlen(expected_sha256) != 64) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < 32; i++) {
+        int hi = hex_nibble(expected_sha256[2 * i]);
+        int lo = hex_nibble(expected_sha256[2 * i + 1]);
+        if (hi < 0 || lo < 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        up->expected[i] = (uint8_t)((hi << 4) | lo);
+    }
+
+    // 总是写入非活动槽位，活动页面在整个上传过程中保持可用
+    up->slot = (s_active == 0) ? 1 : 0;
+    up->fd = fopen(s_slot_paths[up->slot], "w");
+    if (up->fd == NULL) {
+        ESP_LOGE(TAG, "无法创建 %s", s_slot_paths[up->slot]);
+        return ESP_FAIL;
+    }
+
+    mbedtls_sha256_init(&up->sha);
+    mbedtls_sha256_starts(&up->sha, 0);
+    return ESP_OK;
+}
+
+esp_err_t ui_upload_write(ui_upload_t *up, const void *data, size_t len)
+{
+    if (up->written + len > UI_MAX_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (fwrite(data, 1, len, up->fd) != len) {
+        return ESP_FAIL;  // 通常是SPIFFS空间不足
+    }
+    mbedtls_sha256_update(&up->sha, data, len);
+    up->written += len;
+    return ESP_OK;
+}
+
+void ui_upload_abort(ui_upload_t *up)
+{
+    if (up->fd) {
+        fclose(up->fd);
+        up->fd = NULL;
+        remove(s_slot_paths[up->slot]);
+        mbedtls_sha256_free(&up->sha);
+    }
+}
+
+esp_err_t ui_upload_finish(ui_upload_t *up)
+{
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&up->sha, digest);
+
+    // 先确保数据落盘，再校验
+    if (fclose(up->fd) != 0) {
+        up->fd = NULL;
+        remove(s_slot_paths[up->slot]);
+        mbedtls_sha256_free(&up->sha);
+        return ESP_FAIL;
+    }
+    up->fd = NULL;
+    mbedtls_sha256_free(&up->sha);
+
+    if (memcmp(digest, up->expected, sizeof(digest)) != 0) {
+        ESP_LOGW(TAG, "页面哈希校验失败");
+        remove(s_slot_paths[up->slot]);
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    // 切换活动槽位
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(UI_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err == ESP_OK) {
+        err = nvs_set_u8(nvs_handle, UI_KEY_ACTIVE, up->slot);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "切换页面槽位失败: %s", esp_err_to_name(err));
+        remove(s_slot_paths[up->slot]);
+        return err;
+    }
+
+    s_active = up->slot;
+    ESP_LOGI(TAG, "页面已更新到槽位%d，%d字节", up->slot, (int)up->written);
+    return ESP_OK;
+}
@@ -0,0 +1,50 @@
+/*
+ * @Author: jxingnian j_xingnian@163.com
+ * @Date: 2026-10-19 15:00:00
+ * @Description: Web界面资源的双槽存储
+ *
+ * 新上传的页面写入SPIFFS中非活动的槽位文件，边写边计算SHA-256，
+ * 校验通过后才把NVS中的活动槽位号切换过去。NVS单个键的写入是原子的，
+ * 断电重启后只会看到旧页面或完整的新页面。从未上传过时使用烧录的 /spiffs/index.html。
+ */
+
+#ifndef _UI_STORE_H_
+#define _UI_STORE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "esp_err.h"
+#include "mbedtls/sha256.h"
+
+#define UI_MAX_SIZE     (512 * 1024)
+#define UI_FACTORY_PATH "/spiffs/index.html"    // 烧录的页面，从未上传过时使用
+
+// 一次上传会话
+typedef struct {
+    FILE *fd;
+    uint8_t slot;                   // 正在写入的槽位
+    size_t written;
+    mbedtls_sha256_context sha;
+    uint8_t expected[32];
+} ui_upload_t;
+
+// 读取当前活动槽位
+esp_err_t ui_store_init(void);
+
+// 当前应返回给浏览器的页面文件路径
+const char *ui_store_active_path(void);
+
+// 开始上传，expected_sha256为64位十六进制字符串
+esp_err_t ui_upload_begin(ui_upload_t *up, const char *expected_sha256);
+
+// 写入一段数据
+esp_err_t ui_upload_write(ui_upload_t *up, const void *data, size_t len);
+
+// 结束上传：校验哈希并切换活动槽位，失败时删除已写入的文件
+esp_err_t ui_upload_finish(ui_upload_t *up);
+
+// 放弃上传
+void ui_upload_abort(ui_upload_t *up);
+
+#endif /* _UI_STORE_H_ */
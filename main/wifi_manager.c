@@ -1,6 +1,7 @@
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_mac.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
@@ -9,6 +10,8 @@
 #include "lwip/err.h"
 #include "lwip/sys.h"
 #include "wifi_manager.h"
+#include "trace_log.h"
+#include "provision_store.h"
 
 // WiFi配置参数
 #define EXAMPLE_ESP_WIFI_SSID      CONFIG_ESP_WIFI_SSID        // WiFi名称
@@ -18,8 +21,43 @@
 
 static const char *TAG = "wifi_manager";  // 日志标签
 
-#define MAX_RETRY_COUNT 5
+#define MAX_RETRY_COUNT PROVISION_DEFAULT_RETRY
 static int s_retry_num = 0;
+static int s_max_retry = MAX_RETRY_COUNT;   // 可由批量配网的设备设置修改
+static int s_profile_attempts = 0;          // 本轮已切换过的凭据组数
+static volatile wifi_state_t s_state = WIFI_STATE_IDLE;
+static volatile bool s_roaming = false;     // 漫游主动断开，下一次断开不计入重试
+static SemaphoreHandle_t s_scan_lock = NULL;
+
+// 当前网络重试失败后切换到下一组已保存的凭据，所有凭据都试过后返回false
+static bool switch_to_next_profile(void)
+{
+    provision_data_t data;
+    if (provision_store_load(&data) != ESP_OK || s_profile_attempts >= data.count) {
+        return false;
+    }
+
+    wifi_config_t sta_config = {0};
+    esp_wifi_get_config(ESP_IF_WIFI_STA, &sta_config);
+    int next = 0;
+    for (int i = 0; i < data.count; i++) {
+        if (strcmp((char *)sta_config.sta.ssid, data.profiles[i].ssid) == 0) {
+            next = (i + 1) % data.count;
+            break;
+        }
+    }
+    s_profile_attempts++;
+
+    memset(&sta_config, 0, sizeof(sta_config));
+    strlcpy((char *)sta_config.sta.ssid, data.profiles[next].ssid, sizeof(sta_config.sta.ssid));
+    strlcpy((char *)sta_config.sta.password, data.profiles[next].password, sizeof(sta_config.sta.password));
+    ESP_LOGI(TAG, "切换到备用WiFi配置: %s", sta_config.sta.ssid);
+    if (esp_wifi_set_config(ESP_IF_WIFI_STA, &sta_config) != ESP_OK) {
+        return false;
+    }
+    s_retry_num = 0;
+    return esp_wifi_connect() == ESP_OK;
+}
 
 // WiFi事件处理函数
 static void wifi_event_handler(void* arg, esp_event_base_t event_base,
@@ -39,7 +77,11 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
                 break;
             case WIFI_EVENT_STA_START:
                 ESP_LOGI(TAG, "WIFI_EVENT_STA_START，尝试连接到AP...");
-                esp_wifi_connect();
+                wifi_config_t sta_config;
+                if (esp_wifi_get_config(ESP_IF_WIFI_STA, &sta_config) == ESP_OK &&
+                    sta_config.sta.ssid[0] != '\0' && esp_wifi_connect() == ESP_OK) {
+                    s_state = WIFI_STATE_CONNECTING;
+                }
                 break;
             case WIFI_EVENT_STA_CONNECTED:
                 ESP_LOGI(TAG, "WIFI_EVENT_STA_CONNECTED，已连接到AP");
@@ -48,12 +90,19 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
             case WIFI_EVENT_STA_DISCONNECTED:
                 wifi_event_sta_disconnected_t* event = (wifi_event_sta_disconnected_t*) event_data;
                 ESP_LOGW(TAG, "WiFi断开连接，原因:%d", event->reason);
-                if (s_retry_num < MAX_RETRY_COUNT) {
-                    ESP_LOGI(TAG, "重试连接到AP... (%d/%d)", s_retry_num + 1, MAX_RETRY_COUNT);
-                    esp_wifi_connect();
+                if (s_roaming) {
+                    // 计划内的漫游，直接按新锁定的BSSID重连，不消耗重试次数也不切换凭据
+                    s_roaming = false;
+                    s_state = esp_wifi_connect() == ESP_OK ? WIFI_STATE_CONNECTING : WIFI_STATE_IDLE;
+                } else if (s_retry_num < s_max_retry) {
+                    ESP_LOGI(TAG, "重试连接到AP... (%d/%d)", s_retry_num + 1, s_max_retry);
+                    s_state = esp_wifi_connect() == ESP_OK ? WIFI_STATE_CONNECTING : WIFI_STATE_IDLE;
                     s_retry_num++;
+                } else if (switch_to_next_profile()) {
+                    s_state = WIFI_STATE_CONNECTING;
                 } else {
                     ESP_LOGW(TAG, "WiFi连接失败，达到最大重试次数");
+                    s_state = WIFI_STATE_FAILED;
                     // 保存当前状态到NVS
                     nvs_handle_t nvs_handle;
                     esp_err_t err = nvs_open("wifi_state", NVS_READWRITE, &nvs_handle);
@@ -70,6 +119,8 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
             ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
             ESP_LOGI(TAG, "获取到IP地址:" IPSTR, IP2STR(&event->ip_info.ip));
             s_retry_num = 0; // 重置重试计数
+            s_profile_attempts = 0;
+            s_state = WIFI_STATE_CONNECTED;
             // 保存成功状态到NVS
             nvs_handle_t nvs_handle;
             esp_err_t err = nvs_open("wifi_state", NVS_READWRITE, &nvs_handle);
@@ -85,6 +136,17 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
 // 初始化WiFi软AP
 esp_err_t wifi_init_softap(void)
 {
+    // 读取批量配网写入的设备设置
+    provision_data_t provision;
+    bool has_provision = (provision_store_load(&provision) == ESP_OK);
+    s_max_retry = provision.settings.max_retry;
+    uint8_t ap_channel = provision.settings.ap_channel ? provision.settings.ap_channel : EXAMPLE_ESP_WIFI_CHANNEL;
+
+    s_scan_lock = xSemaphoreCreateMutex();
+    if (s_scan_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
     ESP_ERROR_CHECK(esp_netif_init());  // 初始化底层TCP/IP堆栈
     ESP_ERROR_CHECK(esp_event_loop_create_default());  // 创建默认事件循环
     esp_netif_create_default_wifi_ap();  // 创建默认WIFI AP
@@ -111,7 +173,7 @@ esp_err_t wifi_init_softap(void)
         .ap = {
             .ssid = EXAMPLE_ESP_WIFI_SSID,
             .ssid_len = strlen(EXAMPLE_ESP_WIFI_SSID),
-            .channel = EXAMPLE_ESP_WIFI_CHANNEL,
+            .channel = ap_channel,
             .password = EXAMPLE_ESP_WIFI_PASS,
             .max_connection = EXAMPLE_MAX_STA_CONN,
             .authmode = WIFI_AUTH_WPA_WPA2_PSK,
@@ -152,12 +214,21 @@ esp_err_t wifi_init_softap(void)
         }
         nvs_close(nvs_handle);
     }
+    
+    // 没有单独保存的配置时使用批量配网的第一组凭据
+    if (err != ESP_OK && has_provision && provision.count > 0) {
+        wifi_config_t sta_config = {0};
+        strlcpy((char *)sta_config.sta.ssid, provision.profiles[0].ssid, sizeof(sta_config.sta.ssid));
+        strlcpy((char *)sta_config.sta.password, provision.profiles[0].password, sizeof(sta_config.sta.password));
+        ESP_LOGI(TAG, "使用批量配网的WiFi配置，SSID: %s", sta_config.sta.ssid);
+        ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &sta_config));
+    }
 
     // 启动WiFi
     ESP_ERROR_CHECK(esp_wifi_start());
 
     ESP_LOGI(TAG, "WiFi初始化完成. SSID:%s 密码:%s 信道:%d",
-             EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS, EXAMPLE_ESP_WIFI_CHANNEL);
+             EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS, ap_channel);
     return ESP_OK;
 }
 
@@ -188,8 +259,14 @@ esp_err_t wifi_scan_networks(wifi_ap_record_t **ap_records, uint16_t *ap_count)
     };
 
     // 开始扫描
+    if (!wifi_manager_scan_lock(WIFI_SCAN_LOCK_WAIT_MS)) {
+        free(*ap_records);
+        *ap_records = NULL;
+        return ESP_ERR_TIMEOUT;
+    }
     ret = esp_wifi_scan_start(&scan_config, true);
     if (ret != ESP_OK) {
+        wifi_manager_scan_unlock();
         ESP_LOGE(TAG, "开始扫描失败");
         free(*ap_records);
         *ap_records = NULL;
@@ -198,6 +275,7 @@ esp_err_t wifi_scan_networks(wifi_ap_record_t **ap_records, uint16_t *ap_count)
 
     // 获取扫描结果
     ret = esp_wifi_scan_get_ap_records(&number, *ap_records);
+    wifi_manager_scan_unlock();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "获取扫描结果失败");
         free(*ap_records);
@@ -219,11 +297,69 @@ esp_err_t wifi_scan_networks(wifi_ap_record_t **ap_records, uint16_t *ap_count)
         *ap_count = DEFAULT_SCAN_LIST_SIZE;
     }
 
-    // 打印扫描结果
-    ESP_LOGI(TAG, "发现 %d 个接入点:", *ap_count);
+    // 记录扫描结果
+    TRACE_1(TRACE_EVT_SCAN_COUNT, *ap_count);
     for (int i = 0; i < *ap_count; i++) {
-        ESP_LOGI(TAG, "SSID: %s, 信号强度: %d", (*ap_records)[i].ssid, (*ap_records)[i].rssi);
+        TRACE_4(TRACE_EVT_SCAN_AP, i, (*ap_records)[i].rssi,
+                (*ap_records)[i].primary, (*ap_records)[i].authmode);
     }
 
     return ESP_OK;
 }
+
+// 使用新的STA配置发起连接
+esp_err_t wifi_connect_sta(wifi_config_t *sta_config)
+{
+    esp_err_t err = esp_wifi_set_mode(WIFI_MODE_APSTA);
+    if (err == ESP_OK) {
+        err = esp_wifi_set_config(ESP_IF_WIFI_STA, sta_config);
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+    s_retry_num = 0;  // 新配置重新计算重试次数
+    s_profile_attempts = 0;
+    s_state = WIFI_STATE_CONNECTING;
+    return esp_wifi_connect();
+}
+
+bool wifi_manager_scan_lock(uint32_t wait_ms)
+{
+    return s_scan_lock != NULL && xSemaphoreTake(s_scan_lock, pdMS_TO_TICKS(wait_ms)) == pdTRUE;
+}
+
+void wifi_manager_scan_unlock(void)
+{
+    xSemaphoreGive(s_scan_lock);
+}
+
+void wifi_manager_set_roaming(bool roaming)
+{
+    s_roaming = roaming;
+}
+
+// 设置单个网络的最大重试次数
+void wifi_manager_set_max_retry(int max_retry)
+{
+    s_max_retry = max_retry;
+}
+
+// 获取STA连接状态
+wifi_state_t wifi_manager_get_state(void)
+{
+    wifi_mode_t mode;
+    if (esp_wifi_get_mode(&mode) != ESP_OK || !(mode & WIFI_MODE_STA)) {
+        return WIFI_STATE_IDLE;
+    }
+    return s_state;
+}
+
+const char *wifi_manager_state_name(wifi_state_t state)
+{
+    switch (state) {
+    case WIFI_STATE_CONNECTING: return "connecting";
+    case WIFI_STATE_CONNECTED:  return "connected";
+    case WIFI_STATE_FAILED:     return "failed";
+    default:                    return "idle";
+    }
+}
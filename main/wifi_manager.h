@@ -1,13 +1,45 @@
 #ifndef WIFI_MANAGER_H
 #define WIFI_MANAGER_H
 
+#include <stdbool.h>
 #include "esp_wifi.h"
 #include "esp_event.h"
 
+// STA连接状态
+typedef enum {
+    WIFI_STATE_IDLE,        // 未配置或未启用STA
+    WIFI_STATE_CONNECTING,  // 正在连接或重试中
+    WIFI_STATE_CONNECTED,   // 已获取IP
+    WIFI_STATE_FAILED,      // 达到最大重试次数
+} wifi_state_t;
+
 // WiFi初始化函数
 esp_err_t wifi_init_softap(void);
 
 // WiFi扫描函数
 esp_err_t wifi_scan_networks(wifi_ap_record_t **ap_records, uint16_t *ap_count);
 
+// 扫描锁：HTTP扫描、信道选择和漫游都会调用esp_wifi_scan_start，同时只能进行一个，
+// 后启动的扫描会失败或覆盖前一个的结果。从停止旧扫描到取回结果期间持有。
+// 后台任务传0，拿不到锁时等下一个周期；HTTP扫描等待WIFI_SCAN_LOCK_WAIT_MS
+#define WIFI_SCAN_LOCK_WAIT_MS  5000
+bool wifi_manager_scan_lock(uint32_t wait_ms);
+void wifi_manager_scan_unlock(void);
+
+// 使用新的STA配置发起连接，并重置重试计数；失败时返回错误码，由调用方报告
+esp_err_t wifi_connect_sta(wifi_config_t *sta_config);
+
+// 即将为漫游主动断开时在esp_wifi_disconnect之前置位，断开失败时清除；
+// 置位后的下一次断开直接重连，不计入重试次数，也不切换到备用凭据
+void wifi_manager_set_roaming(bool roaming);
+
+// 设置单个网络的最大重试次数
+void wifi_manager_set_max_retry(int max_retry);
+
+// 获取STA连接状态
+wifi_state_t wifi_manager_get_state(void);
+
+// 状态名称，用于接口输出
+const char *wifi_manager_state_name(wifi_state_t state);
+
 #endif // WIFI_MANAGER_H
@@ -0,0 +1,183 @@
+/*
+ * 在主机上检查流式请求体解析器
+ *
+ * 编译:
+ *     gcc -Itools/host -Imain -o body_parser_test tools/body_parser_test.c main/body_parser.c
+ * 用法:
+ *     ./body_parser_test
+ *
+ * 每个用例分别整块喂入和逐字节喂入，结果应一致。全部通过返回0，否则打印失败的用例并返回1。
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "body_parser.h"
+#include "host_test.h"
+
+// 记录回调收到的每条记录，字段之间用'|'分隔，未出现的字段记为'-'
+typedef struct {
+    char log[512];
+    int records;
+} record_log_t;
+
+static esp_err_t log_record(body_field_t *fields, size_t count, void *ctx)
+{
+    record_log_t *log = (record_log_t *)ctx;
+    size_t len = strlen(log->log);
+    len += snprintf(log->log + len, sizeof(log->log) - len, "%s", log->records++ ? ";" : "");
+    for (size_t i = 0; i < count; i++) {
+        len += snprintf(log->log + len, sizeof(log->log) - len, "%s%s", i ? "|" : "",
+                        fields[i].present ? fields[i].buf : "-");
+    }
+    return ESP_OK;
+}
+
+static esp_err_t parse(const char *body, body_format_t format, body_field_t *fields, size_t count,
+                       body_record_cb_t cb, void *ctx, bool bytewise)
+{
+    body_parser_t p;
+    body_parser_init(&p, format, fields, count, cb, ctx);
+    size_t len = strlen(body);
+    esp_err_t err = ESP_OK;
+    if (bytewise) {
+        for (size_t i = 0; i < len && err == ESP_OK; i++) {
+            err = body_parser_feed(&p, body + i, 1);
+        }
+    } else {
+        err = body_parser_feed(&p, body, len);
+    }
+    return err == ESP_OK ? body_parser_finish(&p) : err;
+}
+
+// 解析后按回调记录比较，expect为NULL时期望解析失败
+static void expect_records(const char *name, const char *body, body_format_t format,
+                           const char *const *keys, size_t count, const char *expect)
+{
+    char bufs[5][72];
+    body_field_t fields[5];
+    for (int pass = 0; pass < 2; pass++) {
+        record_log_t log = {0};
+        for (size_t i = 0; i < count; i++) {
+            fields[i] = (body_field_t){ .key = keys[i], .buf = bufs[i], .size = sizeof(bufs[i]) };
+        }
+        esp_err_t err = parse(body, format, fields, count, log_record, &log, pass == 1);
+        if (expect == NULL) {
+            CHECK(err != ESP_OK, name);
+        } else {
+            CHECK(err == ESP_OK, name);
+            CHECK(strcmp(log.log, expect) == 0, name);
+            if (strcmp(log.log, expect) != 0) {
+                printf("     got \"%s\", expected \"%s\"\n", log.log, expect);
+            }
+        }
+    }
+}
+
+// 不带回调时解析结束后直接读取字段，删除接口即按此方式读取ssid
+static void test_no_callback(void)
+{
+    static const struct {
+        const char *body;
+        body_format_t format;
+        const char *ssid;       // NULL表示不应出现
+    } cases[] = {
+        { "{\"ssid\":\"x\"}",                    BODY_FORMAT_JSON, "x" },
+        { "{ \"ssid\" : \"Home WiFi\" }",        BODY_FORMAT_JSON, "Home WiFi" },
+        { "{}",                                  BODY_FORMAT_JSON, NULL },
+        { "{\"other\":1}",                       BODY_FORMAT_JSON, NULL },
+        { "{\"ssid\":\"x\",\"password\":\"\"}",    BODY_FORMAT_JSON, "x" },
+        { "ssid=x",                              BODY_FORMAT_FORM, "x" },
+        { "ssid=a&ssid=b",                       BODY_FORMAT_FORM, "b" },
+        { "[{\"ssid\":\"a\"},{\"ssid\":\"b\"}]", BODY_FORMAT_JSON, "b" },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        for (int pass = 0; pass < 2; pass++) {
+            char ssid[33];
+            body_field_t fields[] = {
+                { .key = "ssid", .buf = ssid, .size = sizeof(ssid) },
+            };
+            esp_err_t err = parse(cases[i].body, cases[i].format, fields, 1, NULL, NULL, pass == 1);
+            CHECK(err == ESP_OK, cases[i].body);
+            CHECK(fields[0].present == (cases[i].ssid != NULL), cases[i].body);
+            if (cases[i].ssid != NULL) {
+                CHECK(strcmp(ssid, cases[i].ssid) == 0, cases[i].body);
+            }
+        }
+    }
+}
+
+static void test_literals(void)
+{
+    static const char *const keys[] = { "ssid", "n" };
+    expect_records("true/false/null", "{\"a\":true,\"b\":false,\"c\":null,\"ssid\":\"x\"}",
+                   BODY_FORMAT_JSON, keys, 2, "x|-");
+    expect_records("number", "{\"n\":-12.5e3,\"ssid\":\"x\"}", BODY_FORMAT_JSON, keys, 2, "x|-12.5e3");
+    expect_records("top-level true", "true", BODY_FORMAT_JSON, keys, 2, "");
+    expect_records("nul", "{\"a\":nul}", BODY_FORMAT_JSON, keys, 2, NULL);
+    expect_records("tru", "{\"a\":tru,\"ssid\":\"x\"}", BODY_FORMAT_JSON, keys, 2, NULL);
+    expect_records("truex", "{\"a\":truex}", BODY_FORMAT_JSON, keys, 2, NULL);
+    expect_records("nulL", "[nulL]", BODY_FORMAT_JSON, keys, 2, NULL);
+    expect_records("top-level fals", "fals", BODY_FORMAT_JSON, keys, 2, NULL);
+    expect_records("number with letters", "{\"n\":12abc}", BODY_FORMAT_JSON, keys, 2, NULL);
+    expect_records("fraction and exponent", "{\"n\":0.5E-2}", BODY_FORMAT_JSON, keys, 2, "-|0.5E-2");
+    expect_records("top-level number", "12", BODY_FORMAT_JSON, keys, 2, "");
+    expect_records("leading zero", "{\"n\":01}", BODY_FORMAT_JSON, keys, 2, NULL);
+    expect_records("minus inside", "{\"n\":1-2}", BODY_FORMAT_JSON, keys, 2, NULL);
+    expect_records("bare minus", "{\"n\":-}", BODY_FORMAT_JSON, keys, 2, NULL);
+    expect_records("trailing dot", "{\"n\":1.}", BODY_FORMAT_JSON, keys, 2, NULL);
+    expect_records("empty exponent", "{\"n\":1e+}", BODY_FORMAT_JSON, keys, 2, NULL);
+    expect_records("top-level trailing dot", "1.", BODY_FORMAT_JSON, keys, 2, NULL);
+
+    // 关注的字段只能是标量，未关注的字段可以是任意值
+    expect_records("array for watched key", "{\"ssid\":[\"x\"]}", BODY_FORMAT_JSON, keys, 2, NULL);
+    expect_records("object for watched key", "{\"ssid\":{\"a\":\"x\"}}", BODY_FORMAT_JSON, keys, 2, NULL);
+    expect_records("array for watched number", "{\"n\":[1]}", BODY_FORMAT_JSON, keys, 2, NULL);
+    expect_records("array for other key", "{\"other\":[\"x\",{\"y\":1}],\"ssid\":\"y\"}",
+                   BODY_FORMAT_JSON, keys, 2, "y|-");
+}
+
+static void test_records(void)
+{
+    static const char *const keys[] = { "ssid", "password" };
+    expect_records("single", "{\"ssid\":\"a\",\"password\":\"12345678\"}",
+                   BODY_FORMAT_JSON, keys, 2, "a|12345678");
+    expect_records("array", "[{\"ssid\":\"a\"},{\"ssid\":\"b\",\"password\":\"p\"}]",
+                   BODY_FORMAT_JSON, keys, 2, "a|-;b|p");
+    expect_records("wrapped", "{\"networks\":[{\"ssid\":\"a\"},{\"ssid\":\"b\"}]}",
+                   BODY_FORMAT_JSON, keys, 2, "a|-;b|-");
+    expect_records("form", "ssid=a+b&password=x%21&ssid=c", BODY_FORMAT_FORM, keys, 2, "a b|x!;c|-");
+    expect_records("escape", "{\"ssid\":\"\\u4e2d\\\"\"}", BODY_FORMAT_JSON, keys, 2, "\xe4\xb8\xad\"|-");
+    expect_records("unterminated", "{\"ssid\":\"a\"", BODY_FORMAT_JSON, keys, 2, NULL);
+    expect_records("trailing", "{\"ssid\":\"a\"}x", BODY_FORMAT_JSON, keys, 2, NULL);
+}
+
+// 批量配网的顶层键顺序任意，每组凭据、设置和校验和都应是独立的记录
+static void test_batch_key_order(void)
+{
+    static const char *const keys[] = { "ssid", "password", "max_retry", "ap_channel", "checksum" };
+    static const char *const bodies[] = {
+        "{\"profiles\":[{\"ssid\":\"a\",\"password\":\"p1\"},{\"ssid\":\"b\",\"password\":\"p2\"}],"
+        "\"settings\":{\"max_retry\":5,\"ap_channel\":6},\"checksum\":\"c0ffee\"}",
+        "{\"checksum\":\"c0ffee\",\"settings\":{\"max_retry\":5,\"ap_channel\":6},"
+        "\"profiles\":[{\"ssid\":\"a\",\"password\":\"p1\"},{\"ssid\":\"b\",\"password\":\"p2\"}]}",
+        "{\"settings\":{\"ap_channel\":6,\"max_retry\":5},\"profiles\":[{\"password\":\"p1\",\"ssid\":\"a\"},"
+        "{\"password\":\"p2\",\"ssid\":\"b\"}],\"checksum\":\"c0ffee\"}",
+    };
+    static const char *const expect[] = {
+        "a|p1|-|-|-;b|p2|-|-|-;-|-|5|6|-;-|-|-|-|c0ffee",
+        "-|-|-|-|c0ffee;-|-|5|6|-;a|p1|-|-|-;b|p2|-|-|-",
+        "-|-|5|6|-;a|p1|-|-|-;b|p2|-|-|-;-|-|-|-|c0ffee",
+    };
+    for (size_t i = 0; i < sizeof(bodies) / sizeof(bodies[0]); i++) {
+        expect_records("batch key order", bodies[i], BODY_FORMAT_JSON, keys, 5, expect[i]);
+    }
+}
+
+int main(void)
+{
+    test_no_callback();
+    test_literals();
+    test_records();
+    test_batch_key_order();
+    return test_report();
+}
@@ -0,0 +1,54 @@
+/*
+ * 在主机上用记录下来的扫描结果回放SoftAP信道评分
+ *
+ * 编译:
+ *     gcc -Imain -o channel_replay tools/channel_replay.c main/channel_plan.c
+ * 用法:
+ *     ./channel_replay [当前信道 [迟滞百分比 [最大信道]]] < tools/channel_fixtures/office.txt
+ *
+ * 每行一个AP: "信道 RSSI [SSID]"，以#开头的行忽略。可以把 /api/channel 的survey整理成这种格式。
+ * 文件中有 "# expect: N" 时检查选出的信道，不一致时返回1，方便修改评分后批量回归。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "channel_plan.h"
+
+int main(int argc, char **argv)
+{
+    int current = argc > 1 ? atoi(argv[1]) : 0;
+    int hysteresis = argc > 2 ? atoi(argv[2]) : 25;
+    int max_channel = argc > 3 ? atoi(argv[3]) : 13;
+    int expect = 0;
+
+    channel_plan_t plan;
+    channel_plan_reset(&plan);
+
+    char line[128];
+    while (fgets(line, sizeof(line), stdin)) {
+        int channel, rssi;
+        if (line[0] == '#') {
+            const char *p = strstr(line, "expect:");
+            if (p != NULL) {
+                expect = atoi(p + strlen("expect:"));
+            }
+            continue;
+        }
+        if (sscanf(line, "%d %d", &channel, &rssi) == 2) {
+            channel_plan_add(&plan, (uint8_t)channel, (int8_t)rssi);
+        }
+    }
+
+    uint8_t best = channel_plan_best(&plan, (uint8_t)max_channel);
+    uint8_t chosen = channel_plan_choose(&plan, (uint8_t)current, (uint8_t)max_channel, (uint8_t)hysteresis);
+    for (int ch = 1; ch <= max_channel; ch++) {
+        printf("%3d  aps=%2u score=%6lu%s%s\n", ch, plan.aps[ch], (unsigned long)plan.score[ch],
+               ch == best ? " best" : "", ch == chosen ? " CHOSEN" : "");
+    }
+    if (expect != 0 && expect != chosen) {
+        printf("expected %d, chose %u\n", expect, chosen);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""
+在局域网中查找配网设备
+
+用法:
+    python3 tools/discover.py                      # 向255.255.255.255广播
+    python3 tools/discover.py --multicast          # 发送到组播组239.255.42.99
+    python3 tools/discover.py --addr 127.0.0.1     # 发送到指定地址，例如本机测试
+    python3 tools/discover.py --id 246F28A1B2C3    # 只查找指定设备
+
+一次发送，在超时时间内收集所有设备的回复。
+"""
+
+import argparse
+import json
+import socket
+import time
+
+QUERY = b'ESPWIFI_DISCOVER'
+GROUP = '239.255.42.99'
+PORT = 48899
+
+
+def discover(addr, port, device_id=None, timeout=1.0):
+    query = QUERY + (b' ' + device_id.encode() if device_id else b'')
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_BROADCAST, 1)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, 1)
+    sock.sendto(query, (addr, port))
+
+    devices = {}
+    deadline = time.monotonic() + timeout
+    while True:
+        remaining = deadline - time.monotonic()
+        if remaining <= 0:
+            break
+        sock.settimeout(remaining)
+        try:
+            data, (host, _) = sock.recvfrom(512)
+        except socket.timeout:
+            break
+        try:
+            info = json.loads(data)
+        except ValueError:
+            continue
+        info['from'] = host
+        devices[info.get('id', host)] = info
+    sock.close()
+    return list(devices.values())
+
+
+def main():
+    parser = argparse.ArgumentParser(description='查找局域网中的配网设备')
+    parser.add_argument('--addr', default='255.255.255.255', help='目标地址')
+    parser.add_argument('--multicast', action='store_true', help='发送到组播组 ' + GROUP)
+    parser.add_argument('--port', type=int, default=PORT)
+    parser.add_argument('--id', help='只查找指定设备ID')
+    parser.add_argument('--timeout', type=float, default=1.0, help='等待回复的秒数')
+    args = parser.parse_args()
+
+    addr = GROUP if args.multicast else args.addr
+    devices = discover(addr, args.port, args.id, args.timeout)
+    for d in devices:
+        print('%-12s  %-15s  ap=%-15s  port=%-5s  fw=%-8s  %s' % (
+            d.get('id'), d.get('ip') or d['from'], d.get('ap_ip'), d.get('port'),
+            d.get('fw'), d.get('state')))
+    if not devices:
+        print('未发现设备')
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    raise SystemExit(main())
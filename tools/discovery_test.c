@@ -0,0 +1,176 @@
+/*
+ * 在主机上检查局域网发现报文，并在回环地址上跑一次请求/回复
+ *
+ * 编译:
+ *     gcc -Itools/host -Imain -o discovery_test tools/discovery_test.c main/discovery_packet.c
+ * 用法:
+ *     ./discovery_test                   检查请求匹配、回复生成和一次回环往返，全部通过返回0
+ *     ./discovery_test --serve 48899     在本机应答，配合 python3 tools/discover.py --addr 127.0.0.1
+ *
+ * 应答使用固定的设备信息，设备ID为 246F28A1B2C3。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include "discovery_packet.h"
+#include "host_test.h"
+
+#define DEVICE_ID  "246F28A1B2C3"
+
+static const discovery_info_t s_info = {
+    .id = DEVICE_ID,
+    .fw = "1.0.0",
+    .state = "connected",
+    .sta_ip = 0x1701A8C0,   // 192.168.1.23，按内存顺序即网络字节序
+    .ap_ip = 0x0104A8C0,    // 192.168.4.1
+    .port = 8080,
+};
+
+static bool match(const char *query)
+{
+    return discovery_match_query((const uint8_t *)query, strlen(query), DEVICE_ID);
+}
+
+static void test_match(void)
+{
+    CHECK(match("ESPWIFI_DISCOVER"), "plain query");
+    CHECK(match("ESPWIFI_DISCOVER\r\n"), "query with newline");
+    CHECK(match("ESPWIFI_DISCOVER " DEVICE_ID), "query for this device");
+    CHECK(match("ESPWIFI_DISCOVER 246f28a1b2c3\n"), "device id is case-insensitive");
+    CHECK(!match("ESPWIFI_DISCOVER 246F28A1B2C4"), "query for another device");
+    CHECK(!match("ESPWIFI_DISCOVER 246F28A1B2C"), "device id prefix");
+    CHECK(!match("ESPWIFI_DISCOVERX"), "longer keyword");
+    CHECK(!match("ESPWIFI_DISCO"), "short packet");
+    CHECK(!match(""), "empty packet");
+}
+
+static void test_reply(void)
+{
+    char buf[DISCOVERY_MAX_PACKET];
+    const char *expect = "{\"id\":\"" DEVICE_ID "\",\"ip\":\"192.168.1.23\",\"ap_ip\":\"192.168.4.1\","
+                         "\"port\":8080,\"fw\":\"1.0.0\",\"state\":\"connected\"}";
+    size_t len = discovery_build_reply(buf, sizeof(buf), &s_info);
+    CHECK(len == strlen(expect) && strcmp(buf, expect) == 0, "reply");
+
+    // 未连接时没有STA地址
+    discovery_info_t idle = s_info;
+    idle.sta_ip = 0;
+    idle.state = "idle";
+    len = discovery_build_reply(buf, sizeof(buf), &idle);
+    CHECK(len > 0 && strstr(buf, "\"ip\":\"\"") != NULL && strstr(buf, "\"state\":\"idle\"") != NULL, "idle reply");
+
+    CHECK(discovery_build_reply(buf, 16, &s_info) == 0, "buffer too small");
+}
+
+static int bind_udp(uint16_t port)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (sock < 0 || bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("bind");
+        if (sock >= 0) {
+            close(sock);
+        }
+        return -1;
+    }
+    struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return sock;
+}
+
+// 与设备上的discovery_task相同：收到匹配的请求就单播回复
+static void answer_one(int sock)
+{
+    uint8_t query[64];
+    char reply[DISCOVERY_MAX_PACKET];
+    struct sockaddr_in client;
+    socklen_t client_len = sizeof(client);
+    ssize_t len = recvfrom(sock, query, sizeof(query), 0, (struct sockaddr *)&client, &client_len);
+    if (len < 0 || !discovery_match_query(query, (size_t)len, DEVICE_ID)) {
+        return;
+    }
+    size_t reply_len = discovery_build_reply(reply, sizeof(reply), &s_info);
+    if (reply_len > 0) {
+        sendto(sock, reply, reply_len, 0, (struct sockaddr *)&client, client_len);
+    }
+}
+
+static void test_round_trip(void)
+{
+    int responder = bind_udp(0);
+    int client = bind_udp(0);
+    CHECK(responder >= 0 && client >= 0, "loopback sockets");
+    if (responder < 0 || client < 0) {
+        return;
+    }
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    getsockname(responder, (struct sockaddr *)&addr, &addr_len);
+
+    static const struct {
+        const char *query;
+        bool answered;
+    } cases[] = {
+        { "ESPWIFI_DISCOVER", true },
+        { "ESPWIFI_DISCOVER " DEVICE_ID, true },
+        { "ESPWIFI_DISCOVER 000000000000", false },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        sendto(client, cases[i].query, strlen(cases[i].query), 0, (struct sockaddr *)&addr, addr_len);
+        answer_one(responder);
+
+        char reply[DISCOVERY_MAX_PACKET + 1];
+        struct timeval timeout = { .tv_sec = 0, .tv_usec = 200000 };
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ssize_t len = recv(client, reply, sizeof(reply) - 1, 0);
+        if (cases[i].answered) {
+            CHECK(len > 0, cases[i].query);
+            if (len > 0) {
+                reply[len] = '\0';
+                CHECK(strstr(reply, "\"id\":\"" DEVICE_ID "\"") != NULL, cases[i].query);
+            }
+        } else {
+            CHECK(len < 0, cases[i].query);
+        }
+    }
+    close(responder);
+    close(client);
+}
+
+static int serve(uint16_t port)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (sock < 0 || bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("bind");
+        return 1;
+    }
+    printf("answering discovery on port %u as %s\n", port, DEVICE_ID);
+    while (1) {
+        answer_one(sock);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 2 && strcmp(argv[1], "--serve") == 0) {
+        return serve((uint16_t)atoi(argv[2]));
+    }
+    test_match();
+    test_reply();
+    test_round_trip();
+    return test_report();
+}
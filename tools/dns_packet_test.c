@@ -0,0 +1,171 @@
+/*
+ * 在主机上检查强制门户的DNS应答
+ *
+ * 编译:
+ *     gcc -Itools/host -Imain -o dns_packet_test tools/dns_packet_test.c main/dns_packet.c
+ * 用法:
+ *     ./dns_packet_test                  检查内置的查询报文，全部通过返回0
+ *     ./dns_packet_test --serve 5353     在127.0.0.1:5353应答，配合本地解析客户端测试:
+ *                                        dig @127.0.0.1 -p 5353 connectivitycheck.gstatic.com
+ *
+ * 所有A记录都解析到192.168.4.1，与设备上的默认AP地址一致。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "dns_packet.h"
+#include "host_test.h"
+
+#define PORTAL_IP  "192.168.4.1"
+
+static uint16_t u16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// 按 id / flags / 域名 / qtype 拼一个查询，edns为真时追加一条OPT附加记录(dig默认如此)
+static size_t build_query(uint8_t *buf, uint16_t id, uint16_t flags, const char *name,
+                          uint16_t qtype, bool edns)
+{
+    size_t len = 0;
+    uint8_t header[12] = { id >> 8, id & 0xFF, flags >> 8, flags & 0xFF, 0, 1, 0, 0, 0, 0, 0, edns ? 1 : 0 };
+    memcpy(buf, header, sizeof(header));
+    len = sizeof(header);
+    while (*name) {
+        const char *dot = strchr(name, '.');
+        size_t label = dot ? (size_t)(dot - name) : strlen(name);
+        buf[len++] = (uint8_t)label;
+        memcpy(buf + len, name, label);
+        len += label;
+        name += label + (dot ? 1 : 0);
+    }
+    buf[len++] = 0;
+    buf[len++] = qtype >> 8;
+    buf[len++] = qtype & 0xFF;
+    buf[len++] = 0;
+    buf[len++] = 1;     // IN
+    if (edns) {
+        static const uint8_t opt[] = { 0, 0, 41, 0x10, 0, 0, 0, 0, 0, 0, 0 };
+        memcpy(buf + len, opt, sizeof(opt));
+        len += sizeof(opt);
+    }
+    return len;
+}
+
+static void test_a_record(void)
+{
+    uint8_t query[DNS_MAX_PACKET], resp[DNS_MAX_PACKET];
+    uint32_t ip = inet_addr(PORTAL_IP);
+
+    size_t qlen = build_query(query, 0x1234, 0x0100, "connectivitycheck.gstatic.com", 1, true);
+    size_t question_end = qlen - 11;
+    size_t len = dns_build_response(query, qlen, resp, sizeof(resp), ip);
+    CHECK(len == question_end + 16, "A");
+    if (len != question_end + 16) {
+        return;
+    }
+    CHECK(u16(resp) == 0x1234, "A id");
+    CHECK(u16(resp + 2) == 0x8500, "A flags: QR|AA|RD, no RA, NOERROR");
+    CHECK(u16(resp + 4) == 1 && u16(resp + 6) == 1, "A counts");
+    CHECK(u16(resp + 8) == 0 && u16(resp + 10) == 0, "A drops EDNS");
+    CHECK(memcmp(resp + 12, query + 12, question_end - 12) == 0, "A question echoed");
+    const uint8_t *a = resp + question_end;
+    CHECK(u16(a) == 0xC00C, "A name pointer");
+    CHECK(u16(a + 2) == 1 && u16(a + 4) == 1, "A type/class");
+    CHECK(u16(a + 6) == 0 && u16(a + 8) == DNS_ANSWER_TTL, "A ttl");
+    CHECK(u16(a + 10) == 4 && memcmp(a + 12, &ip, 4) == 0, "A address");
+
+    // 不要求递归时RD也不应出现在应答中
+    qlen = build_query(query, 1, 0x0000, "example.com", 1, false);
+    len = dns_build_response(query, qlen, resp, sizeof(resp), ip);
+    CHECK(len == qlen + 16 && u16(resp + 2) == 0x8400, "A without RD");
+
+    // ANY同样给出A记录
+    qlen = build_query(query, 2, 0x0100, "example.com", 255, false);
+    len = dns_build_response(query, qlen, resp, sizeof(resp), ip);
+    CHECK(len == qlen + 16 && u16(resp + 6) == 1, "ANY");
+}
+
+static void test_no_answer(void)
+{
+    uint8_t query[DNS_MAX_PACKET], resp[DNS_MAX_PACKET];
+    uint32_t ip = inet_addr(PORTAL_IP);
+
+    // AAAA返回无应答的NOERROR，客户端改用IPv4
+    size_t qlen = build_query(query, 3, 0x0100, "captive.apple.com", 28, false);
+    size_t len = dns_build_response(query, qlen, resp, sizeof(resp), ip);
+    CHECK(len == qlen, "AAAA length");
+    CHECK(u16(resp + 2) == 0x8500 && u16(resp + 6) == 0, "AAAA no answer");
+}
+
+static void test_rejected(void)
+{
+    uint8_t query[DNS_MAX_PACKET], resp[DNS_MAX_PACKET];
+    uint32_t ip = inet_addr(PORTAL_IP);
+    size_t qlen = build_query(query, 4, 0x0100, "example.com", 1, false);
+
+    CHECK(dns_build_response(query, 11, resp, sizeof(resp), ip) == 0, "shorter than header");
+    CHECK(dns_build_response(query, qlen - 1, resp, sizeof(resp), ip) == 0, "truncated question");
+    CHECK(dns_build_response(query, qlen, resp, qlen + 15, ip) == 0, "response buffer too small");
+
+    query[2] |= 0x80;   // QR
+    CHECK(dns_build_response(query, qlen, resp, sizeof(resp), ip) == 0, "response packet");
+    query[2] = 0x28;    // opcode 5 (UPDATE)
+    CHECK(dns_build_response(query, qlen, resp, sizeof(resp), ip) == 0, "non-standard opcode");
+    query[2] = 0x01;
+
+    query[5] = 0;       // QDCOUNT 0
+    CHECK(dns_build_response(query, qlen, resp, sizeof(resp), ip) == 0, "no question");
+    query[5] = 1;
+
+    query[12] = 0xC0;   // 问题中使用压缩指针
+    CHECK(dns_build_response(query, qlen, resp, sizeof(resp), ip) == 0, "compressed question");
+    query[12] = 60;     // 标签长度超出报文
+    CHECK(dns_build_response(query, qlen, resp, sizeof(resp), ip) == 0, "label past end");
+}
+
+// 在本地端口上应答，直到被中断
+static int serve(int port)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons((uint16_t)port),
+        .sin_addr.s_addr = inet_addr("127.0.0.1"),
+    };
+    if (sock < 0 || bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("bind");
+        return 1;
+    }
+    printf("listening on 127.0.0.1:%d, answering %s\n", port, PORTAL_IP);
+
+    uint8_t query[DNS_MAX_PACKET], resp[DNS_MAX_PACKET];
+    while (1) {
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        ssize_t n = recvfrom(sock, query, sizeof(query), 0, (struct sockaddr *)&from, &from_len);
+        if (n <= 0) {
+            continue;
+        }
+        size_t len = dns_build_response(query, (size_t)n, resp, sizeof(resp), inet_addr(PORTAL_IP));
+        printf("query %zd bytes -> %zu bytes\n", n, len);
+        if (len > 0) {
+            sendto(sock, resp, len, 0, (struct sockaddr *)&from, from_len);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 2 && strcmp(argv[1], "--serve") == 0) {
+        return serve(atoi(argv[2]));
+    }
+    test_a_record();
+    test_no_answer();
+    test_rejected();
+    return test_report();
+}
@@ -0,0 +1,26 @@
+/*
+ * 主机端测试共用的检查宏，每个测试程序只包含一次
+ */
+
+#ifndef _HOST_TEST_H_
+#define _HOST_TEST_H_
+
+#include <stdio.h>
+
+static int s_failures = 0;
+
+#define CHECK(cond, name) do { \
+        if (!(cond)) { \
+            printf("FAIL %s: %s\n", (name), #cond); \
+            s_failures++; \
+        } \
+    } while (0)
+
+// 打印汇总，返回值直接作为main的返回值：全部通过为0，否则为1
+static inline int test_report(void)
+{
+    printf("%s (%d failures)\n", s_failures ? "FAILED" : "OK", s_failures);
+    return s_failures ? 1 : 0;
+}
+
+#endif /* _HOST_TEST_H_ */
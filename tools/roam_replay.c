@@ -0,0 +1,77 @@
+/*
+ * 在主机上用记录下来的RSSI序列回放漫游判断
+ *
+ * 编译:
+ *     gcc -Imain -o roam_replay tools/roam_replay.c main/link_quality.c
+ * 用法:
+ *     ./roam_replay [阈值 [迟滞]] < tools/roam_fixtures/walk_away.txt
+ *
+ * 每行一个采样: "时间(秒) RSSI [候选AP的RSSI]"，以#开头的行忽略，
+ * RSSI为"D<原因>"时表示一次断开。可以把 /api/link 的samples整理成这种格式。
+ * 文件中有 "# expect: roams=N disconnects=M" 时检查统计结果，不一致时返回1，两项都可以省略。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "link_quality.h"
+
+// 从注释行中读取 "key=N"，没有时保持原值
+static void parse_expect(const char *line, const char *key, long *out)
+{
+    const char *p = strstr(line, key);
+    if (p != NULL) {
+        *out = atol(p + strlen(key));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    lq_params_t params = {
+        .rssi_threshold = argc > 1 ? atoi(argv[1]) : -72,
+        .hysteresis = argc > 2 ? atoi(argv[2]) : 8,
+        .fast_drop = -6,
+        .holdoff = 60,
+    };
+    lq_monitor_t lq;
+    lq_init(&lq);
+    long expect_roams = -1, expect_disconnects = -1;
+
+    char line[128];
+    while (fgets(line, sizeof(line), stdin)) {
+        unsigned long ts;
+        char value[16];
+        int candidate;
+        if (line[0] == '#') {
+            if (strstr(line, "expect:") != NULL) {
+                parse_expect(line, "roams=", &expect_roams);
+                parse_expect(line, "disconnects=", &expect_disconnects);
+            }
+            continue;
+        }
+        int n = sscanf(line, "%lu %15s %d", &ts, value, &candidate);
+        if (n < 2) {
+            continue;
+        }
+        if (value[0] == 'D') {
+            lq_add_disconnect(&lq, ts, (uint8_t)atoi(value + 1));
+            printf("%6lu  disconnect reason=%s\n", ts, value + 1);
+            continue;
+        }
+        lq_add_rssi(&lq, ts, (int8_t)atoi(value));
+        bool degraded = lq_degraded(&lq, &params, ts);
+        bool roam = n == 3 && lq_should_roam(&lq, &params, ts, (int8_t)candidate);
+        printf("%6lu  rssi=%4s avg=%4d trend=%4d%s%s\n", ts, value, lq_average(&lq),
+               lq_trend(&lq, ts), degraded ? " degraded" : "", roam ? " ROAM" : "");
+        if (roam) {
+            lq_note_roam(&lq, ts);
+        }
+    }
+    printf("roams=%lu disconnects=%lu\n", (unsigned long)lq.roams, (unsigned long)lq.disconnects);
+    if ((expect_roams >= 0 && expect_roams != (long)lq.roams) ||
+        (expect_disconnects >= 0 && expect_disconnects != (long)lq.disconnects)) {
+        printf("expected roams=%ld disconnects=%ld\n", expect_roams, expect_disconnects);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""
+按编译配置分别编译固件，并输出各配置的Flash和RAM占用
+
+用法:
+    python3 tools/size_report.py                 # 编译并比较 full 和 profiles/ 下的全部配置
+    python3 tools/size_report.py minimal         # 只比较 full 和 minimal
+    python3 tools/size_report.py --no-build      # 使用已有的 build_<配置名> 目录
+
+full 即仓库中的 sdkconfig；其他配置为 profiles/<名称>.cfg，叠加在 sdkconfig 之上。
+需要先执行 ESP-IDF 的 export 脚本。
+"""
+
+import json
+import os
+import subprocess
+import sys
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), '..'))
+PROFILES_DIR = os.path.join(ROOT, 'profiles')
+
+
+def list_profiles(names):
+    if not names:
+        names = sorted(f[:-4] for f in os.listdir(PROFILES_DIR) if f.endswith('.cfg'))
+    return ['full'] + [n for n in names if n != 'full']
+
+
+def build(name):
+    build_dir = os.path.join(ROOT, 'build_' + name)
+    defaults = [os.path.join(ROOT, 'sdkconfig')]
+    if name != 'full':
+        defaults.append(os.path.join(PROFILES_DIR, name + '.cfg'))
+    os.makedirs(build_dir, exist_ok=True)
+    # 每次从默认值重新生成，避免沿用上一次的配置
+    sdkconfig = os.path.join(build_dir, 'sdkconfig')
+    if os.path.exists(sdkconfig):
+        os.remove(sdkconfig)
+    subprocess.run(['idf.py', '-B', build_dir,
+                    '-D', 'SDKCONFIG=' + sdkconfig,
+                    '-D', 'SDKCONFIG_DEFAULTS=' + ';'.join(defaults),
+                    'build'], cwd=ROOT, check=True)
+
+
+def measure(name):
+    build_dir = os.path.join(ROOT, 'build_' + name)
+    with open(os.path.join(build_dir, 'project_description.json'), encoding='utf-8') as f:
+        desc = json.load(f)
+    app_bin = os.path.join(build_dir, desc['app_bin'])
+    map_file = os.path.join(build_dir, desc['project_name'] + '.map')
+
+    idf_size = os.path.join(os.environ['IDF_PATH'], 'tools', 'idf_size.py')
+    out = subprocess.run([sys.executable, idf_size, '--json', map_file],
+                         check=True, capture_output=True, text=True).stdout
+    size = json.loads(out)
+
+    # ESP32-S3的内部RAM为DIRAM，其他芯片分别统计DRAM和IRAM
+    if 'used_diram' in size:
+        ram = size['used_diram']
+        ram_free = size.get('diram_remain', 0)
+    else:
+        ram = size.get('used_dram', 0) + size.get('used_iram', 0)
+        ram_free = size.get('dram_remain', 0)
+    return {
+        'image': os.path.getsize(app_bin),
+        'flash_code': size.get('flash_code', 0),
+        'flash_rodata': size.get('flash_rodata', 0),
+        'ram': ram,
+        'ram_free': ram_free,
+    }
+
+
+def main():
+    args = sys.argv[1:]
+    if '-h' in args or '--help' in args:
+        print(__doc__)
+        return 0
+    no_build = '--no-build' in args
+    profiles = list_profiles([a for a in args if not a.startswith('-')])
+
+    results = {}
+    for name in profiles:
+        if not no_build:
+            build(name)
+        results[name] = measure(name)
+
+    base = results['full']
+    columns = ('image', 'flash_code', 'flash_rodata', 'ram', 'ram_free')
+    print('%-10s' % 'profile' + ''.join('%16s' % c for c in columns))
+    for name in profiles:
+        row = results[name]
+        cells = []
+        for c in columns:
+            if name == 'full':
+                cells.append('%16d' % row[c])
+            else:
+                cells.append('%16s' % ('%d (%+d)' % (row[c], row[c] - base[c])))
+        print('%-10s' % name + ''.join(cells))
+    print('\nimage为应用分区中的固件大小（分区为1MB），ram为静态占用的内部RAM，ram_free越大启动后可用堆越多')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""
+解码 /api/logs?format=bin 导出的二进制跟踪记录
+
+用法:
+    curl -s "http://192.168.4.1:8080/api/logs?format=bin" -o trace.bin
+    python3 tools/trace_decode.py trace.bin
+"""
+
+import os
+import re
+import struct
+import sys
+
+EVENTS_H = os.path.join(os.path.dirname(__file__), '..', 'main', 'trace_events.h')
+HEADER = struct.Struct('<IHH')
+RECORD = struct.Struct('<IIHH4i')
+MAGIC = 0x31525454
+
+
+def load_events(path):
+    pattern = re.compile(r'^TRACE_EVENT\(\s*(\w+)\s*,\s*"([^"]*)"\s*,\s*"([^"]*)"\s*\)', re.M)
+    with open(path, encoding='utf-8') as f:
+        return [(tag, fmt) for _, tag, fmt in pattern.findall(f.read())]
+
+
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__)
+        return 1
+
+    events = load_events(EVENTS_H)
+    with open(sys.argv[1], 'rb') as f:
+        data = f.read()
+
+    magic, record_size, _ = HEADER.unpack_from(data, 0)
+    if magic != MAGIC or record_size != RECORD.size:
+        print('不是有效的跟踪导出文件', file=sys.stderr)
+        return 1
+
+    for off in range(HEADER.size, len(data) - RECORD.size + 1, RECORD.size):
+        _, ts_ms, event_id, _, *args = RECORD.unpack_from(data, off)
+        if event_id >= len(events):
+            print('(%u) ? unknown event %u' % (ts_ms, event_id))
+            continue
+        tag, fmt = events[event_id]
+        used = fmt.count('%') - 2 * fmt.count('%%')
+        print('(%u) %s: %s' % (ts_ms, tag, fmt % tuple(args[:used])))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())